@@ -50,6 +50,8 @@ def install_cycamore(args):
             cmake_cmd += ['-DCYCLUS_ROOT_DIR='+absexpanduser(args.cyclus_root)]
         if args.build_type:
             cmake_cmd += ['-DCMAKE_BUILD_TYPE=' + args.build_type]
+        if args.instrument:
+            cmake_cmd += ['-DCYCAMORE_INSTRUMENT=ON']
         check_windows_cmake(cmake_cmd)
         rtn = subprocess.check_call(cmake_cmd, cwd=absexpanduser(args.build_dir), shell=(os.name=='nt'))
 
@@ -119,6 +121,9 @@ def main():
     build_type = "the CMAKE_BUILD_TYPE"
     parser.add_argument('--build_type', help=build_type)
 
+    instrument = "build archetype hot-path timers and counters"
+    parser.add_argument('--instrument', action='store_true', help=instrument)
+
     args = parser.parse_args()
     if args.uninstall:
         uninstall_cycamore(args)
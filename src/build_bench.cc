@@ -0,0 +1,104 @@
+// cycamore_build_bench - measures how fast agents of a prototype are built.
+//
+// usage: cycamore_build_bench <input file> <prototype> [n] [rounds]
+//
+// The prototype is read from the (xml) input file along with the recipes
+// defined there.  Each round clones n agents (default 1000) from the prototype
+// as a deployment wave would, builds them - which includes EnterNotify and
+// recording their entry - and deletes them again.  The best and mean
+// throughput of each phase over all rounds (default 5) is reported in agents
+// per second.
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cyclus.h"
+#include "instrument.h"
+#include "proto_input.h"
+
+namespace {
+
+struct Rate {
+  Rate() : n(0), total(0), best(0) {}
+  void Add(int agents, double secs) {
+    double r = agents / std::max(secs, 1e-9);
+    n++;
+    total += r;
+    best = std::max(best, r);
+  }
+  int n;
+  double total;
+  double best;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  using cycamore::instrument::WallTime;
+
+  if (argc < 3) {
+    std::cerr << "usage: " << argv[0]
+              << " <input file> <prototype> [n] [rounds]\n";
+    return 1;
+  }
+  int n = argc > 3 ? std::max(1, std::atoi(argv[3])) : 1000;
+  int rounds = argc > 4 ? std::max(1, std::atoi(argv[4])) : 5;
+  cyclus::Logger::ReportLevel() = cyclus::LEV_ERROR;
+
+  try {
+    cycamore::RecipeMap recipes;
+    std::string spec;
+    std::string config =
+        cycamore::ReadPrototype(argv[1], argv[2], &recipes, &spec);
+    cyclus::MockSim sim(cyclus::AgentSpec(spec), config, 1);
+    cycamore::RecipeMap::iterator rec;
+    for (rec = recipes.begin(); rec != recipes.end(); ++rec) {
+      sim.AddRecipe(rec->first, rec->second);
+    }
+    cyclus::Context* ctx = sim.agent->context();
+    std::string proto = sim.agent->prototype();
+
+    std::map<std::string, Rate> rates;
+    std::vector<cyclus::Agent*> agents(n);
+    for (int r = 0; r < rounds; ++r) {
+      double t = WallTime();
+      for (int i = 0; i < n; ++i) {
+        agents[i] = ctx->CreateAgent<cyclus::Agent>(proto);
+      }
+      rates["clone"].Add(n, WallTime() - t);
+
+      t = WallTime();
+      for (int i = 0; i < n; ++i) {
+        agents[i]->Build(NULL);
+      }
+      rates["build"].Add(n, WallTime() - t);
+
+      t = WallTime();
+      for (int i = 0; i < n; ++i) {
+        ctx->DelAgent(agents[i]);
+      }
+      rates["delete"].Add(n, WallTime() - t);
+    }
+
+    std::cout << argv[2] << " (" << spec << "): " << rounds << " rounds of "
+              << n << " agents\n";
+    std::cout << std::left << std::setw(10) << "phase" << std::right
+              << std::setw(16) << "best_per_s" << std::setw(16)
+              << "mean_per_s" << "\n";
+    std::map<std::string, Rate>::iterator it;
+    for (it = rates.begin(); it != rates.end(); ++it) {
+      const Rate& rt = it->second;
+      std::cout << std::left << std::setw(10) << it->first << std::right
+                << std::fixed << std::setprecision(0) << std::setw(16)
+                << rt.best << std::setw(16) << rt.total / rt.n << "\n";
+    }
+  } catch (cyclus::Error& e) {
+    std::cerr << "error: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
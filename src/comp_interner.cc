@@ -0,0 +1,178 @@
+#include "comp_interner.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/uuid/nil_generator.hpp>
+#include <boost/uuid/uuid.hpp>
+
+namespace cycamore {
+
+namespace {
+
+// fractions closer than this are the same - and hash the same unless they
+// round to different multiples of it
+const double kTol = 1e-10;
+
+}  // namespace
+
+CompInterner::CompInterner()
+    : n_sweep_(64),
+      sim_(boost::uuids::nil_uuid()) {}
+
+CompInterner* CompInterner::Instance(cyclus::Context* ctx) {
+  static CompInterner interner;
+  MutexLock lock(&interner.mu_);
+  if (ctx->sim_id() != interner.sim_) {
+    interner.Reset();
+    interner.sim_ = ctx->sim_id();
+  }
+  return &interner;
+}
+
+cyclus::Composition::Ptr CompInterner::Intern(cyclus::Composition::Ptr c) {
+  MutexLock lock(&mu_);
+  {
+    MutexLock nucdata_lock(NucDataMutex());
+    c->mass();
+    c->atom();
+  }
+  const cyclus::CompMap& v = c->mass();
+  unsigned long h = Hash(v);
+  cyclus::Composition::Ptr found = Find(&mass_, h, v, false);
+  if (found) {
+    return found;
+  }
+  Add(&mass_, h, c);
+  return c;
+}
+
+int CompInterner::size() {
+  MutexLock lock(&mu_);
+  return atom_.size() + mass_.size();
+}
+
+cyclus::Composition::Ptr CompInterner::Atom(const cyclus::CompMap& v) {
+  cyclus::CompMap n(v);
+  cyclus::compmath::Normalize(&n);
+  unsigned long h = Hash(n);
+  MutexLock lock(&mu_);
+  cyclus::Composition::Ptr c = Find(&atom_, h, n, true);
+  if (!c) {
+    {
+      MutexLock id_lock(IdMutex());
+      c = cyclus::Composition::CreateFromAtom(n);
+    }
+    MutexLock nucdata_lock(NucDataMutex());
+    c->mass();
+    Add(&atom_, h, c);
+  }
+  return c;
+}
+
+cyclus::Composition::Ptr CompInterner::Mass(const cyclus::CompMap& v) {
+  cyclus::CompMap n(v);
+  cyclus::compmath::Normalize(&n);
+  unsigned long h = Hash(n);
+  MutexLock lock(&mu_);
+  cyclus::Composition::Ptr c = Find(&mass_, h, n, false);
+  if (!c) {
+    {
+      MutexLock id_lock(IdMutex());
+      c = cyclus::Composition::CreateFromMass(n);
+    }
+    MutexLock nucdata_lock(NucDataMutex());
+    c->atom();
+    Add(&mass_, h, c);
+  }
+  return c;
+}
+
+void CompInterner::Clear() {
+  MutexLock lock(&mu_);
+  Reset();
+}
+
+void CompInterner::Reset() {
+  atom_.clear();
+  mass_.clear();
+  n_sweep_ = 64;
+}
+
+cyclus::Composition::Ptr CompInterner::Find(Table* t, unsigned long h,
+                                            const cyclus::CompMap& v,
+                                            bool atom) {
+  std::pair<Table::iterator, Table::iterator> r = t->equal_range(h);
+  Table::iterator it = r.first;
+  while (it != r.second) {
+    cyclus::Composition::Ptr c = it->second.lock();
+    if (!c) {
+      t->erase(it++);
+      continue;
+    }
+    if (Same(v, atom ? c->atom() : c->mass())) {
+      return c;
+    }
+    ++it;
+  }
+  return cyclus::Composition::Ptr();
+}
+
+void CompInterner::Add(Table* t, unsigned long h,
+                       cyclus::Composition::Ptr c) {
+  t->insert(std::make_pair(h, boost::weak_ptr<cyclus::Composition>(c)));
+  if (atom_.size() + mass_.size() < n_sweep_) {
+    return;
+  }
+  Sweep(&atom_);
+  Sweep(&mass_);
+  n_sweep_ = std::max(64, 2 * static_cast<int>(atom_.size() + mass_.size()));
+}
+
+void CompInterner::Sweep(Table* t) {
+  Table::iterator it = t->begin();
+  while (it != t->end()) {
+    if (it->second.expired()) {
+      t->erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+unsigned long CompInterner::Hash(const cyclus::CompMap& v) {
+  unsigned long h = 0;
+  cyclus::CompMap::const_iterator it;
+  for (it = v.begin(); it != v.end(); ++it) {
+    if (it->second == 0) {
+      continue;
+    }
+    h = h * 31 + it->first;
+    h = h * 31 + static_cast<unsigned long>(std::floor(it->second / kTol + 0.5));
+  }
+  return h;
+}
+
+bool CompInterner::Same(const cyclus::CompMap& a, const cyclus::CompMap& b) {
+  cyclus::CompMap::const_iterator i = a.begin();
+  cyclus::CompMap::const_iterator j = b.begin();
+  while (true) {
+    // nuclides with zero fractions don't count
+    while (i != a.end() && i->second == 0) {
+      ++i;
+    }
+    while (j != b.end() && j->second == 0) {
+      ++j;
+    }
+    if (i == a.end() || j == b.end()) {
+      return i == a.end() && j == b.end();
+    }
+    if (i->first != j->first || std::fabs(i->second - j->second) > kTol) {
+      return false;
+    }
+    ++i;
+    ++j;
+  }
+}
+
+}  // namespace cycamore
@@ -0,0 +1,90 @@
+#ifndef CYCAMORE_SRC_COMP_INTERNER_H_
+#define CYCAMORE_SRC_COMP_INTERNER_H_
+
+#include <map>
+
+#include <boost/uuid/uuid.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "cyclus.h"
+#include "mutex.h"
+
+namespace cycamore {
+
+/// Shared compositions for the compositions archetypes make themselves.
+///
+/// Mixing or enriching material builds a new composition object every time,
+/// even when its content is the same as one made before - by the same agent
+/// or another one.  Every new object defeats the caches keyed on composition
+/// objects and, once part of a tracked material, adds its nuclides to the
+/// Compositions table.  A CompInterner hands out one composition per content
+/// instead: compositions are looked up by a hash of their normalized
+/// nuclide fractions, and fractions within 1e-10 of each other are taken to
+/// be the same.
+///
+/// Compositions are only held weakly - one is forgotten once nothing else
+/// uses it.
+///
+/// An interner may be used by several threads at once.  The compositions it
+/// hands out have both their atom and mass fractions computed, so agents
+/// sharing them only ever read them.
+class CompInterner {
+ public:
+  CompInterner();
+
+  /// Returns the interner for the simulation of context ctx.  Compositions
+  /// are recorded once per simulation, so the interner starts over when a new
+  /// simulation uses it.
+  static CompInterner* Instance(cyclus::Context* ctx);
+
+  /// Returns the shared composition with the same mass fractions as c - c
+  /// itself if there is none yet.
+  cyclus::Composition::Ptr Intern(cyclus::Composition::Ptr c);
+
+  /// Returns the shared composition with atom fractions v, which need not be
+  /// normalized.
+  cyclus::Composition::Ptr Atom(const cyclus::CompMap& v);
+
+  /// Returns the shared composition with mass fractions v, which need not be
+  /// normalized.
+  cyclus::Composition::Ptr Mass(const cyclus::CompMap& v);
+
+  /// Forgets all compositions.
+  void Clear();
+
+  /// Returns the number of compositions held - including ones not yet found
+  /// to be unused.
+  int size();
+
+ private:
+  typedef std::multimap<unsigned long,
+                        boost::weak_ptr<cyclus::Composition> > Table;
+
+  /// Clear without locking.
+  void Reset();
+
+  /// Returns the composition in t with (normalized) fractions v, or a null
+  /// pointer if there is none.  Drops the unused compositions it comes across.
+  cyclus::Composition::Ptr Find(Table* t, unsigned long h,
+                                const cyclus::CompMap& v, bool atom);
+
+  /// Adds composition c with hash h to t - dropping all unused compositions
+  /// once the interner has doubled in size since they were last dropped.
+  void Add(Table* t, unsigned long h, cyclus::Composition::Ptr c);
+
+  /// Drops the unused compositions in t.
+  static void Sweep(Table* t);
+
+  static unsigned long Hash(const cyclus::CompMap& v);
+  static bool Same(const cyclus::CompMap& a, const cyclus::CompMap& b);
+
+  Table atom_;
+  Table mass_;
+  int n_sweep_;
+  boost::uuids::uuid sim_;
+  Mutex mu_;
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_COMP_INTERNER_H_
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include "comp_interner.h"
+
+using cyclus::CompMap;
+using cyclus::Composition;
+
+namespace cycamore {
+namespace compinternertests {
+
+CompMap uox(double u235) {
+  CompMap m;
+  m[922350000] = u235;
+  m[922380000] = 1 - u235;
+  return m;
+}
+
+TEST(CompInternerTests, Intern) {
+  CompInterner interner;
+  Composition::Ptr c1 = Composition::CreateFromMass(uox(0.04));
+  Composition::Ptr c2 = Composition::CreateFromMass(uox(0.04));
+  Composition::Ptr c3 = Composition::CreateFromMass(uox(0.05));
+
+  EXPECT_EQ(c1, interner.Intern(c1));
+  EXPECT_EQ(c1, interner.Intern(c2));
+  EXPECT_EQ(c3, interner.Intern(c3));
+  EXPECT_EQ(2, interner.size());
+}
+
+TEST(CompInternerTests, Content) {
+  CompInterner interner;
+  Composition::Ptr c = interner.Mass(uox(0.04));
+  CompMap cm = c->mass();
+  EXPECT_DOUBLE_EQ(0.04, cm[922350000]);
+
+  // not normalized
+  CompMap m = uox(0.04);
+  m[922350000] *= 3;
+  m[922380000] *= 3;
+  EXPECT_EQ(c, interner.Mass(m));
+
+  // zero fractions and round off don't count
+  m = uox(0.04 + 1e-13);
+  m[942390000] = 0;
+  EXPECT_EQ(c, interner.Mass(m));
+
+  EXPECT_NE(c, interner.Mass(uox(0.04 + 1e-6)));
+
+  m = uox(0.04);
+  m[942390000] = 1e-6;
+  EXPECT_NE(c, interner.Mass(m));
+}
+
+TEST(CompInternerTests, Basis) {
+  CompInterner interner;
+  Composition::Ptr ca = interner.Atom(uox(0.04));
+  EXPECT_EQ(ca, interner.Atom(uox(0.04)));
+  EXPECT_NE(ca, interner.Mass(uox(0.04)));
+}
+
+TEST(CompInternerTests, Unused) {
+  CompInterner interner;
+  Composition::Ptr c = interner.Mass(uox(0.04));
+  for (int i = 0; i < 200; i++) {
+    interner.Mass(uox(0.001 * (i + 1)));
+  }
+  // unused compositions are dropped as the interner grows
+  EXPECT_LT(interner.size(), 100);
+  EXPECT_EQ(c, interner.Mass(uox(0.04)));
+
+  interner.Clear();
+  EXPECT_EQ(0, interner.size());
+  EXPECT_NE(c, interner.Mass(uox(0.04)));
+}
+
+}  // namespace compinternertests
+}  // namespace cycamore
@@ -0,0 +1,55 @@
+#include "decay_cache.h"
+
+#include <boost/uuid/nil_generator.hpp>
+
+namespace cycamore {
+
+DecayCache::DecayCache() : sim_(boost::uuids::nil_uuid()) {}
+
+DecayCache* DecayCache::Instance(cyclus::Context* ctx) {
+  static DecayCache cache;
+  MutexLock lock(&cache.mu_);
+  if (ctx->sim_id() != cache.sim_) {
+    cache.ops_.clear();
+    cache.sim_ = ctx->sim_id();
+  }
+  return &cache;
+}
+
+cyclus::Composition::Ptr DecayCache::Decay(cyclus::Composition::Ptr c,
+                                           int dt) {
+  if (dt <= 0) {
+    return c;
+  }
+  Key key(c->id(), dt);
+  // decaying updates the decay chain c shares with its relatives and may
+  // compute c's atom basis - so it is done under the lock too.  Hits are
+  // the common case, so this costs little.
+  MutexLock lock(&mu_);
+  std::map<Key, cyclus::Composition::Ptr>::iterator it = ops_.find(key);
+  if (it != ops_.end()) {
+    return it->second;
+  }
+  cyclus::Composition::Ptr decayed;
+  {
+    MutexLock id_lock(IdMutex());
+    MutexLock nucdata_lock(NucDataMutex());
+    decayed = c->Decay(dt);
+    decayed->mass();
+    decayed->atom();
+  }
+  ops_[key] = decayed;
+  return decayed;
+}
+
+void DecayCache::Clear() {
+  MutexLock lock(&mu_);
+  ops_.clear();
+}
+
+int DecayCache::size() {
+  MutexLock lock(&mu_);
+  return ops_.size();
+}
+
+}  // namespace cycamore
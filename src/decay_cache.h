@@ -0,0 +1,53 @@
+#ifndef CYCAMORE_SRC_DECAY_CACHE_H_
+#define CYCAMORE_SRC_DECAY_CACHE_H_
+
+#include <map>
+#include <utility>
+
+#include <boost/uuid/uuid.hpp>
+
+#include "cyclus.h"
+#include "mutex.h"
+
+namespace cycamore {
+
+/// Decayed compositions by (composition id, elapsed time steps).
+///
+/// Decaying a composition is expensive, and stored material of the same
+/// composition is decayed by the same number of time steps over and over -
+/// e.g. spent fuel discharged to the same recipe and offered or traded the
+/// same number of time steps after discharge.  A DecayCache computes each
+/// decayed composition once and hands out the same composition object after
+/// that.  A DecayCache may be used by several threads at once.
+class DecayCache {
+ public:
+  DecayCache();
+
+  /// Returns the cache for the simulation of context ctx.  Composition ids
+  /// are only unique within a simulation, and the decayed compositions are
+  /// not needed after it, so the cache starts over when a new simulation
+  /// uses it.
+  static DecayCache* Instance(cyclus::Context* ctx);
+
+  /// Returns composition c decayed for dt time steps - c itself if dt is not
+  /// positive.
+  cyclus::Composition::Ptr Decay(cyclus::Composition::Ptr c, int dt);
+
+  /// Forgets all decayed compositions.
+  void Clear();
+
+  /// Returns the number of decayed compositions held.
+  int size();
+
+ private:
+  /// (composition id, elapsed time steps)
+  typedef std::pair<int, int> Key;
+
+  std::map<Key, cyclus::Composition::Ptr> ops_;
+  boost::uuids::uuid sim_;
+  Mutex mu_;
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_DECAY_CACHE_H_
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include "decay_cache.h"
+
+using cyclus::CompMap;
+using cyclus::Composition;
+
+namespace cycamore {
+namespace decaycachetests {
+
+Composition::Ptr spent() {
+  CompMap m;
+  m[942410000] = 0.01;
+  m[922380000] = 0.99;
+  return Composition::CreateFromMass(m);
+}
+
+TEST(DecayCacheTests, Reuse) {
+  DecayCache cache;
+  Composition::Ptr c = spent();
+  Composition::Ptr d = cache.Decay(c, 12);
+  EXPECT_NE(c, d);
+  EXPECT_EQ(d, cache.Decay(c, 12));
+  EXPECT_EQ(1, cache.size());
+
+  EXPECT_NE(d, cache.Decay(c, 24));
+  EXPECT_NE(d, cache.Decay(spent(), 12));
+  EXPECT_EQ(3, cache.size());
+
+  cache.Clear();
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST(DecayCacheTests, NoTime) {
+  DecayCache cache;
+  Composition::Ptr c = spent();
+  EXPECT_EQ(c, cache.Decay(c, 0));
+  EXPECT_EQ(c, cache.Decay(c, -1));
+  EXPECT_EQ(0, cache.size());
+}
+
+}  // namespace decaycachetests
+}  // namespace cycamore
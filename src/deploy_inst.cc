@@ -10,6 +10,9 @@ DeployInst::~DeployInst() {}
 void DeployInst::Build(cyclus::Agent* parent) {
   cyclus::Institution::Build(parent);
   BuildSched::iterator it;
+  // prototype/lifetime combinations already added - schedules often repeat
+  // the same combination for many build times.
+  std::set<std::string> added;
   for (int i = 0; i < prototypes.size(); i++) {
     std::string proto = prototypes[i];
 
@@ -17,12 +20,13 @@ void DeployInst::Build(cyclus::Agent* parent) {
     ss << proto;
 
     if (lifetimes.size() == prototypes.size()) {
-      cyclus::Agent* a = context()->CreateAgent<Agent>(proto);
-      a->lifetime(lifetimes[i]);
-
       ss << "_life_" << lifetimes[i];
       proto = ss.str();
-      context()->AddPrototype(proto, a);
+      if (added.insert(proto).second) {
+        cyclus::Agent* a = context()->CreateAgent<Agent>(prototypes[i]);
+        a->lifetime(lifetimes[i]);
+        context()->AddPrototype(proto, a);
+      }
     }
 
     int t = build_times[i];
@@ -109,6 +109,34 @@ TEST(DeployInstTests, FiniteLifetimes) {
   EXPECT_EQ(8, stmt->GetInt(0));
 }
 
+// the lifetime modded prototype should only be registered once no matter how
+// many times the same prototype/lifetime combination is scheduled.
+TEST(DeployInstTests, RepeatedLifetimes) {
+  std::string config = 
+     "<prototypes>  <val>foobar</val> <val>foobar</val> <val>foobar</val> </prototypes>"
+     "<build_times> <val>1</val>      <val>2</val>      <val>3</val>      </build_times>"
+     "<n_build>     <val>2</val>      <val>2</val>      <val>2</val>      </n_build>"
+     "<lifetimes>   <val>2</val>      <val>2</val>      <val>2</val>      </lifetimes>"
+     ;
+
+  int simdur = 5;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:DeployInst"), config, simdur);
+  sim.DummyProto("foobar");
+  int id = sim.Run();
+
+  cyclus::SqlStatement::Ptr stmt = sim.db().db().Prepare(
+      "SELECT COUNT(*) FROM Prototypes WHERE Prototype = 'foobar_life_2';"
+      );
+  stmt->Step();
+  EXPECT_EQ(1, stmt->GetInt(0));
+
+  stmt = sim.db().db().Prepare(
+      "SELECT COUNT(*) FROM AgentEntry WHERE Prototype = 'foobar' AND Lifetime = 2;"
+      );
+  stmt->Step();
+  EXPECT_EQ(6, stmt->GetInt(0));
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 // required to get functionality in cyclus agent unit tests library
 cyclus::Agent* DeployInstitutionConstructor(cyclus::Context* ctx) {
@@ -0,0 +1,428 @@
+#include "dre_capture.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "mutex.h"
+
+namespace cycamore {
+namespace dre {
+
+namespace {
+
+const char* kMagic = "cycamore-dre-capture";
+const int kVersion = 1;
+
+/// Capture settings, read from the environment on first use.
+struct Config {
+  Config() : time(-1) {
+    const char* t = std::getenv("CYCAMORE_CAPTURE_TIME");
+    if (t != NULL && std::string(t) != "") {
+      time = std::atoi(t);
+    }
+    const char* d = std::getenv("CYCAMORE_CAPTURE_DIR");
+    dir = (d == NULL || std::string(d) == "") ? "." : d;
+    const char* p = std::getenv("CYCAMORE_CAPTURE_PROTOTYPES");
+    if (p != NULL) {
+      std::stringstream ss(p);
+      std::string proto;
+      while (std::getline(ss, proto, ',')) {
+        if (!proto.empty()) {
+          protos.insert(proto);
+        }
+      }
+    }
+  }
+
+  int time;
+  std::string dir;
+  std::set<std::string> protos;
+};
+
+const Config& Conf() {
+  static Config c;
+  return c;
+}
+
+bool Capturing(cyclus::Agent* a) {
+  const Config& c = Conf();
+  if (c.time < 0 || a->context()->time() != c.time) {
+    return false;
+  }
+  return c.protos.empty() || c.protos.count(a->prototype()) > 0;
+}
+
+std::string FileName(cyclus::Agent* a) {
+  std::stringstream ss;
+  ss << Conf().dir << "/" << a->prototype() << "_" << a->id() << "_t"
+     << a->context()->time() << ".dre";
+  return ss.str();
+}
+
+/// position of each request among the requests for its commodity, per agent
+/// id, so that trades can refer back to the captured requests
+typedef std::map<const cyclus::Request<cyclus::Material>*,
+                 std::pair<std::string, int> > RequestIndex;
+
+// guards the map of indexes - each agent's index is only used by that agent
+Mutex indexes_mutex;
+
+RequestIndex& Indexes(cyclus::Agent* a) {
+  static std::map<int, RequestIndex> idx;
+  MutexLock lock(&indexes_mutex);
+  return idx[a->id()];
+}
+
+void Open(std::ofstream& f, cyclus::Agent* a, bool append) {
+  std::string fname = FileName(a);
+  f.open(fname.c_str(), append ? std::ios::app : std::ios::trunc);
+  if (!f.is_open()) {
+    throw cyclus::IOError("could not open DRE capture file " + fname);
+  }
+  f.precision(17);
+}
+
+void WriteMat(std::ostream& os, const MatRecord& m) {
+  os << " " << m.qty << " " << m.comp.size();
+  cyclus::CompMap::const_iterator it;
+  for (it = m.comp.begin(); it != m.comp.end(); ++it) {
+    os << " " << it->first << " " << it->second;
+  }
+}
+
+void ReadMat(std::istream& is, MatRecord* m) {
+  int n = 0;
+  is >> m->qty >> n;
+  for (int i = 0; i < n && is; ++i) {
+    int nuc;
+    double frac;
+    is >> nuc >> frac;
+    m->comp[nuc] = frac;
+  }
+}
+
+}  // namespace
+
+void Capture::WriteBids(std::ostream& os) const {
+  os << kMagic << " " << kVersion << "\n";
+  os << "agent " << agent_id << " " << time << " " << prototype << " " << spec
+     << "\n";
+
+  std::map<std::string, std::vector<MatRecord> >::const_iterator inv;
+  for (inv = inventories.begin(); inv != inventories.end(); ++inv) {
+    for (int i = 0; i < inv->second.size(); ++i) {
+      os << "inv " << inv->first;
+      WriteMat(os, inv->second[i]);
+      os << "\n";
+    }
+  }
+
+  std::map<std::string, std::vector<RequestRecord> >::const_iterator req;
+  for (req = requests.begin(); req != requests.end(); ++req) {
+    for (int i = 0; i < req->second.size(); ++i) {
+      const RequestRecord& r = req->second[i];
+      os << "req " << req->first << " " << r.pref << " " << r.exclusive;
+      WriteMat(os, r.target);
+      os << "\n";
+    }
+  }
+}
+
+void Capture::WriteTrades(std::ostream& os) const {
+  for (int i = 0; i < trades.size(); ++i) {
+    os << "trade " << trades[i].commod << " " << trades[i].index << " "
+       << trades[i].amt << "\n";
+  }
+}
+
+void Capture::WriteAccepts(std::ostream& os) const {
+  for (int i = 0; i < accepts.size(); ++i) {
+    os << "accept " << accepts[i].commod << " " << accepts[i].req_qty;
+    WriteMat(os, accepts[i].mat);
+    os << "\n";
+  }
+}
+
+Capture Capture::Read(std::istream& is) {
+  Capture c;
+  std::string key;
+  int version = 0;
+  is >> key >> version;
+  if (key != kMagic || version != kVersion) {
+    throw cyclus::IOError("not a version 1 cycamore DRE capture");
+  }
+
+  while (is >> key) {
+    if (key == kMagic) {
+      is >> version;  // header repeated by a later capture of the same agent
+    } else if (key == "agent") {
+      is >> c.agent_id >> c.time >> c.prototype >> c.spec;
+    } else if (key == "inv") {
+      std::string name;
+      MatRecord m;
+      is >> name;
+      ReadMat(is, &m);
+      c.inventories[name].push_back(m);
+    } else if (key == "req") {
+      std::string commod;
+      RequestRecord r;
+      is >> commod >> r.pref >> r.exclusive;
+      ReadMat(is, &r.target);
+      c.requests[commod].push_back(r);
+    } else if (key == "trade") {
+      TradeRecord t;
+      is >> t.commod >> t.index >> t.amt;
+      c.trades.push_back(t);
+    } else if (key == "accept") {
+      AcceptRecord a;
+      is >> a.commod >> a.req_qty;
+      ReadMat(is, &a.mat);
+      c.accepts.push_back(a);
+    } else {
+      throw cyclus::IOError("unknown DRE capture entry '" + key + "'");
+    }
+    if (is.fail()) {
+      throw cyclus::IOError("malformed DRE capture entry '" + key + "'");
+    }
+  }
+  return c;
+}
+
+MatRecord ToRecord(cyclus::Material::Ptr m) {
+  MatRecord r;
+  r.qty = m->quantity();
+  r.comp = m->comp()->mass();
+  return r;
+}
+
+cyclus::Material::Ptr ToMaterial(const MatRecord& r) {
+  return cyclus::Material::CreateUntracked(
+      r.qty, cyclus::Composition::CreateFromMass(r.comp));
+}
+
+cyclus::Inventories ToInventories(const Capture& c) {
+  cyclus::Inventories invs;
+  std::map<std::string, std::vector<MatRecord> >::const_iterator it;
+  for (it = c.inventories.begin(); it != c.inventories.end(); ++it) {
+    std::vector<cyclus::Resource::Ptr>& inv = invs[it->first];
+    for (int i = 0; i < it->second.size(); ++i) {
+      inv.push_back(ToMaterial(it->second[i]));
+    }
+  }
+  return invs;
+}
+
+void CaptureBids(cyclus::Agent* a,
+                 const cyclus::CommodMap<cyclus::Material>::type& reqs) {
+  if (!Capturing(a)) {
+    return;
+  }
+
+  Capture c;
+  c.time = a->context()->time();
+  c.agent_id = a->id();
+  c.prototype = a->prototype();
+  c.spec = a->spec();
+
+  cyclus::Inventories invs = a->SnapshotInv();
+  cyclus::Inventories::iterator inv;
+  for (inv = invs.begin(); inv != invs.end(); ++inv) {
+    std::vector<MatRecord>& mats = c.inventories[inv->first];
+    for (int i = 0; i < inv->second.size(); ++i) {
+      cyclus::Material::Ptr m =
+          boost::dynamic_pointer_cast<cyclus::Material>(inv->second[i]);
+      if (m != NULL) {
+        mats.push_back(ToRecord(m));
+      }
+    }
+  }
+
+  RequestIndex& idx = Indexes(a);
+  idx.clear();
+  cyclus::CommodMap<cyclus::Material>::type::const_iterator it;
+  for (it = reqs.begin(); it != reqs.end(); ++it) {
+    std::vector<RequestRecord>& recs = c.requests[it->first];
+    for (int i = 0; i < it->second.size(); ++i) {
+      cyclus::Request<cyclus::Material>* req = it->second[i];
+      RequestRecord r;
+      r.target = ToRecord(req->target());
+      r.pref = req->preference();
+      r.exclusive = req->exclusive();
+      recs.push_back(r);
+      idx[req] = std::make_pair(it->first, i);
+    }
+  }
+
+  std::ofstream f;
+  Open(f, a, false);
+  c.WriteBids(f);
+}
+
+void CaptureTrades(
+    cyclus::Agent* a,
+    const std::vector<cyclus::Trade<cyclus::Material> >& trades) {
+  if (!Capturing(a)) {
+    return;
+  }
+
+  Capture c;
+  RequestIndex& idx = Indexes(a);
+  for (int i = 0; i < trades.size(); ++i) {
+    RequestIndex::iterator it = idx.find(trades[i].request);
+    if (it == idx.end()) {
+      continue;
+    }
+    TradeRecord t;
+    t.commod = it->second.first;
+    t.index = it->second.second;
+    t.amt = trades[i].amt;
+    c.trades.push_back(t);
+  }
+
+  std::ofstream f;
+  Open(f, a, true);
+  c.WriteTrades(f);
+}
+
+void CaptureAccepts(
+    cyclus::Agent* a,
+    const std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                                cyclus::Material::Ptr> >& responses) {
+  if (!Capturing(a)) {
+    return;
+  }
+
+  Capture c;
+  for (int i = 0; i < responses.size(); ++i) {
+    AcceptRecord r;
+    r.commod = responses[i].first.request->commodity();
+    r.req_qty = responses[i].first.request->target()->quantity();
+    r.mat = ToRecord(responses[i].second);
+    c.accepts.push_back(r);
+  }
+
+  std::ofstream f;
+  Open(f, a, true);
+  c.WriteAccepts(f);
+}
+
+Exchange::Exchange(const Capture& c, cyclus::Trader* counterparty)
+    : cap_(c),
+      counterparty_(counterparty) {
+  using cyclus::Material;
+  using cyclus::Request;
+
+  std::map<std::string, std::vector<RequestRecord> >::const_iterator it;
+  for (it = c.requests.begin(); it != c.requests.end(); ++it) {
+    std::vector<Request<Material>*>& reqs = requests_[it->first];
+    for (int i = 0; i < it->second.size(); ++i) {
+      const RequestRecord& r = it->second[i];
+      Request<Material>* req =
+          Request<Material>::Create(ToMaterial(r.target), counterparty_,
+                                    it->first, r.pref, r.exclusive);
+      reqs.push_back(req);
+      reqs_.push_back(req);
+    }
+  }
+}
+
+Exchange::~Exchange() {
+  for (int i = 0; i < reqs_.size(); ++i) {
+    delete reqs_[i];
+  }
+  for (int i = 0; i < bids_.size(); ++i) {
+    delete bids_[i];
+  }
+}
+
+std::vector<cyclus::Trade<cyclus::Material> > Exchange::Trades(
+    const std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr>& ports) {
+  using cyclus::Bid;
+  using cyclus::BidPortfolio;
+  using cyclus::Material;
+  using cyclus::Request;
+
+  std::map<Request<Material>*, Bid<Material>*> bid_for;
+  std::set<BidPortfolio<Material>::Ptr>::const_iterator port;
+  for (port = ports.begin(); port != ports.end(); ++port) {
+    const std::set<Bid<Material>*>& bids = (*port)->bids();
+    std::set<Bid<Material>*>::const_iterator it;
+    for (it = bids.begin(); it != bids.end(); ++it) {
+      bid_for[(*it)->request()] = *it;
+    }
+  }
+
+  std::vector<cyclus::Trade<Material> > trades;
+  for (int i = 0; i < cap_.trades.size(); ++i) {
+    const TradeRecord& t = cap_.trades[i];
+    cyclus::CommodMap<Material>::type::iterator reqs = requests_.find(t.commod);
+    if (reqs == requests_.end() || t.index >= reqs->second.size()) {
+      continue;
+    }
+    Request<Material>* req = reqs->second[t.index];
+    if (bid_for.count(req) == 0) {
+      continue;
+    }
+    trades.push_back(cyclus::Trade<Material>(req, bid_for[req], t.amt));
+  }
+  return trades;
+}
+
+std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                      cyclus::Material::Ptr> > Exchange::Responses(
+    const std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>& ports) {
+  using cyclus::Bid;
+  using cyclus::Material;
+  using cyclus::Request;
+  using cyclus::RequestPortfolio;
+
+  std::map<std::string, std::vector<Request<Material>*> > own;
+  std::set<RequestPortfolio<Material>::Ptr>::const_iterator port;
+  for (port = ports.begin(); port != ports.end(); ++port) {
+    const std::vector<Request<Material>*>& reqs = (*port)->requests();
+    for (int i = 0; i < reqs.size(); ++i) {
+      own[reqs[i]->commodity()].push_back(reqs[i]);
+    }
+  }
+
+  // prefer an unused request of the same size, then any unused request and
+  // finally any request for the commodity
+  std::set<Request<Material>*> used;
+  std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> > responses;
+  for (int i = 0; i < cap_.accepts.size(); ++i) {
+    const AcceptRecord& a = cap_.accepts[i];
+    std::vector<Request<Material>*>& cands = own[a.commod];
+    if (cands.empty()) {
+      continue;
+    }
+    Request<Material>* req = NULL;
+    for (int j = 0; j < cands.size() && req == NULL; ++j) {
+      double qty = cands[j]->target()->quantity();
+      if (used.count(cands[j]) == 0 &&
+          std::abs(qty - a.req_qty) <= cyclus::eps_rsrc()) {
+        req = cands[j];
+      }
+    }
+    for (int j = 0; j < cands.size() && req == NULL; ++j) {
+      if (used.count(cands[j]) == 0) {
+        req = cands[j];
+      }
+    }
+    if (req == NULL) {
+      req = cands[0];
+    }
+    used.insert(req);
+
+    Material::Ptr m = ToMaterial(a.mat);
+    Bid<Material>* bid = Bid<Material>::Create(req, m, counterparty_);
+    bids_.push_back(bid);
+    responses.push_back(
+        std::make_pair(cyclus::Trade<Material>(req, bid, m->quantity()), m));
+  }
+  return responses;
+}
+
+}  // namespace dre
+}  // namespace cycamore
@@ -0,0 +1,160 @@
+#ifndef CYCAMORE_SRC_DRE_CAPTURE_H_
+#define CYCAMORE_SRC_DRE_CAPTURE_H_
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cyclus.h"
+
+/// @file dre_capture.h
+///
+/// Capture and replay of the material exchange inputs of a single agent.
+///
+/// When the CYCAMORE_CAPTURE_TIME environment variable is set to a time step,
+/// the Reactor, FuelFab and Enrichment archetypes write everything the DRE
+/// hands them on that time step to a capture file: their inventories and the
+/// requests they are asked to bid on (GetMatlBids), the trades they are asked
+/// to fill (GetMatlTrades) and the materials they receive (AcceptMatlTrades).
+/// CYCAMORE_CAPTURE_PROTOTYPES may be set to a comma separated list of
+/// prototypes to limit the capture to, and CYCAMORE_CAPTURE_DIR to the
+/// directory to write into (the working directory by default).  One file named
+/// <prototype>_<agent id>_t<time>.dre is written per agent.
+///
+/// The cycamore_dre_replay tool reads a capture file back in, builds a single
+/// agent of the captured prototype from the original input file and runs the
+/// captured exchange on it as many times as asked - see tests/README.rst.
+///
+/// Prototype, commodity and inventory names are written as whitespace
+/// separated tokens and so must not contain whitespace themselves.
+
+namespace cycamore {
+namespace dre {
+
+/// A material as stored in a capture file - its quantity and mass basis
+/// composition.
+struct MatRecord {
+  MatRecord() : qty(0) {}
+  double qty;
+  cyclus::CompMap comp;
+};
+
+/// A request the agent was asked to bid on.
+struct RequestRecord {
+  RequestRecord() : pref(0), exclusive(false) {}
+  MatRecord target;
+  double pref;
+  bool exclusive;
+};
+
+/// A trade the agent was asked to fill.  The request is identified by its
+/// position among the captured requests for the commodity.
+struct TradeRecord {
+  TradeRecord() : index(0), amt(0) {}
+  std::string commod;
+  int index;
+  double amt;
+};
+
+/// A material the agent received for one of its own requests.
+struct AcceptRecord {
+  AcceptRecord() : req_qty(0) {}
+  std::string commod;
+  double req_qty;
+  MatRecord mat;
+};
+
+/// Everything captured for one agent on one time step.
+class Capture {
+ public:
+  Capture() : time(0), agent_id(-1) {}
+
+  /// Writes the header, inventories and requests.
+  void WriteBids(std::ostream& os) const;
+
+  /// Writes the trades.
+  void WriteTrades(std::ostream& os) const;
+
+  /// Writes the accepted materials.
+  void WriteAccepts(std::ostream& os) const;
+
+  /// Reads a capture file written with the above.  Sections may appear more
+  /// than once and are concatenated.
+  /// @throws cyclus::IOError if the stream is not a valid capture
+  static Capture Read(std::istream& is);
+
+  int time;
+  int agent_id;
+  std::string prototype;
+  std::string spec;
+  std::map<std::string, std::vector<MatRecord> > inventories;
+  std::map<std::string, std::vector<RequestRecord> > requests;
+  std::vector<TradeRecord> trades;
+  std::vector<AcceptRecord> accepts;
+};
+
+/// Converts a material to its capture record.
+MatRecord ToRecord(cyclus::Material::Ptr m);
+
+/// Creates an untracked material from its capture record.
+cyclus::Material::Ptr ToMaterial(const MatRecord& r);
+
+/// Creates untracked copies of the captured inventories, suitable for
+/// passing to an agent's InitInv.
+cyclus::Inventories ToInventories(const Capture& c);
+
+/// Archetype hooks - these return immediately unless the calling agent is
+/// being captured on the current time step.
+void CaptureBids(cyclus::Agent* a,
+                 const cyclus::CommodMap<cyclus::Material>::type& reqs);
+void CaptureTrades(cyclus::Agent* a,
+                   const std::vector<cyclus::Trade<cyclus::Material> >& trades);
+void CaptureAccepts(
+    cyclus::Agent* a,
+    const std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                                cyclus::Material::Ptr> >& responses);
+
+/// Rebuilds the exchange a capture was taken from so that it can be handed
+/// to a fresh agent.  Requests and bids created by the exchange are owned by
+/// it and freed when it is destroyed.
+class Exchange {
+ public:
+  /// @param c the capture to replay
+  /// @param counterparty the trader to use as the requester of the captured
+  /// requests and the bidder of the accepted materials
+  Exchange(const Capture& c, cyclus::Trader* counterparty);
+  ~Exchange();
+
+  /// The captured requests, to pass to GetMatlBids.
+  inline cyclus::CommodMap<cyclus::Material>::type& requests() {
+    return requests_;
+  }
+
+  /// Returns the captured trades made on the matching bids in ports (from a
+  /// GetMatlBids call on the requests above), to pass to GetMatlTrades.
+  /// Trades on requests the agent did not bid on this time are dropped.
+  std::vector<cyclus::Trade<cyclus::Material> > Trades(
+      const std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr>& ports);
+
+  /// Returns the captured materials as responses to the agent's own requests
+  /// in ports (from a GetMatlRequests call), to pass to AcceptMatlTrades.
+  /// Requests are matched on commodity and quantity.
+  std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                        cyclus::Material::Ptr> > Responses(
+      const std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>& ports);
+
+ private:
+  const Capture& cap_;
+  cyclus::Trader* counterparty_;
+  cyclus::CommodMap<cyclus::Material>::type requests_;
+  std::vector<cyclus::Request<cyclus::Material>*> reqs_;
+  std::vector<cyclus::Bid<cyclus::Material>*> bids_;
+};
+
+}  // namespace dre
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_DRE_CAPTURE_H_
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "dre_capture.h"
+#include "test_context.h"
+
+using cyclus::BidPortfolio;
+using cyclus::CompMap;
+using cyclus::Material;
+using cyclus::Request;
+
+namespace cycamore {
+namespace dretests {
+
+using dre::AcceptRecord;
+using dre::Capture;
+using dre::MatRecord;
+using dre::RequestRecord;
+using dre::TradeRecord;
+
+MatRecord mat(double qty) {
+  MatRecord m;
+  m.qty = qty;
+  m.comp[922350000] = 0.04;
+  m.comp[922380000] = 0.96;
+  return m;
+}
+
+Capture capture() {
+  Capture c;
+  c.time = 7;
+  c.agent_id = 42;
+  c.prototype = "lwr";
+  c.spec = ":cycamore:Reactor";
+  c.inventories["spent"].push_back(mat(1.0 / 3));
+  c.inventories["spent"].push_back(mat(2));
+
+  RequestRecord r;
+  r.target = mat(10);
+  r.pref = 2.5;
+  r.exclusive = true;
+  c.requests["uox"].push_back(r);
+  r.exclusive = false;
+  r.target = mat(20);
+  c.requests["uox"].push_back(r);
+
+  TradeRecord t;
+  t.commod = "uox";
+  t.index = 1;
+  t.amt = 15;
+  c.trades.push_back(t);
+
+  AcceptRecord a;
+  a.commod = "fresh_uox";
+  a.req_qty = 10;
+  a.mat = mat(9.5);
+  c.accepts.push_back(a);
+  return c;
+}
+
+TEST(DreCaptureTests, RoundTrip) {
+  Capture c = capture();
+  std::stringstream ss;
+  ss.precision(17);
+  c.WriteBids(ss);
+  c.WriteTrades(ss);
+  c.WriteAccepts(ss);
+
+  Capture got = Capture::Read(ss);
+  EXPECT_EQ(7, got.time);
+  EXPECT_EQ(42, got.agent_id);
+  EXPECT_EQ("lwr", got.prototype);
+  EXPECT_EQ(":cycamore:Reactor", got.spec);
+
+  ASSERT_EQ(2, got.inventories["spent"].size());
+  EXPECT_DOUBLE_EQ(1.0 / 3, got.inventories["spent"][0].qty);
+  EXPECT_DOUBLE_EQ(0.96, got.inventories["spent"][1].comp[922380000]);
+
+  ASSERT_EQ(2, got.requests["uox"].size());
+  EXPECT_DOUBLE_EQ(10, got.requests["uox"][0].target.qty);
+  EXPECT_DOUBLE_EQ(2.5, got.requests["uox"][0].pref);
+  EXPECT_TRUE(got.requests["uox"][0].exclusive);
+  EXPECT_FALSE(got.requests["uox"][1].exclusive);
+
+  ASSERT_EQ(1, got.trades.size());
+  EXPECT_EQ("uox", got.trades[0].commod);
+  EXPECT_EQ(1, got.trades[0].index);
+  EXPECT_DOUBLE_EQ(15, got.trades[0].amt);
+
+  ASSERT_EQ(1, got.accepts.size());
+  EXPECT_EQ("fresh_uox", got.accepts[0].commod);
+  EXPECT_DOUBLE_EQ(9.5, got.accepts[0].mat.qty);
+}
+
+TEST(DreCaptureTests, BadCapture) {
+  std::stringstream ss("not a capture");
+  EXPECT_THROW(Capture::Read(ss), cyclus::IOError);
+
+  Capture c = capture();
+  std::stringstream ss2;
+  c.WriteBids(ss2);
+  ss2 << "bogus 1 2 3\n";
+  EXPECT_THROW(Capture::Read(ss2), cyclus::IOError);
+}
+
+TEST(DreCaptureTests, Exchange) {
+  cyclus::TestContext tc;
+  Capture c = capture();
+  dre::Exchange ex(c, tc.trader());
+
+  cyclus::CommodMap<Material>::type& reqs = ex.requests();
+  ASSERT_EQ(2, reqs["uox"].size());
+  EXPECT_DOUBLE_EQ(20, reqs["uox"][1]->target()->quantity());
+  EXPECT_EQ(tc.trader(), reqs["uox"][1]->requester());
+
+  // only the captured trade on a request that was bid on is replayed
+  std::set<BidPortfolio<Material>::Ptr> ports;
+  EXPECT_EQ(0, ex.Trades(ports).size());
+
+  BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
+  port->AddBid(reqs["uox"][1], dre::ToMaterial(mat(20)), tc.trader());
+  ports.insert(port);
+  std::vector<cyclus::Trade<Material> > trades = ex.Trades(ports);
+  ASSERT_EQ(1, trades.size());
+  EXPECT_EQ(reqs["uox"][1], trades[0].request);
+  EXPECT_DOUBLE_EQ(15, trades[0].amt);
+
+  cyclus::Inventories invs = dre::ToInventories(c);
+  ASSERT_EQ(2, invs["spent"].size());
+  EXPECT_DOUBLE_EQ(2, invs["spent"][1]->quantity());
+}
+
+}  // namespace dretests
+}  // namespace cycamore
@@ -0,0 +1,161 @@
+// cycamore_dre_replay - runs a captured material exchange on a single agent.
+//
+// usage: cycamore_dre_replay <input file> <capture file> [repetitions]
+//
+// The agent is built from the configuration of the captured prototype in the
+// (xml) input file the capture was taken from, along with the recipes defined
+// there.  Its inventories are restored from the capture; all other state
+// starts from its initial value.  Each repetition uses a fresh agent and runs
+// GetMatlRequests, GetMatlBids on the captured requests, GetMatlTrades on the
+// captured trades and AcceptMatlTrades on the captured responses, and the
+// fastest and mean time of each call is reported.
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "cyclus.h"
+#include "dre_capture.h"
+#include "instrument.h"
+#include "proto_input.h"
+
+using cyclus::Material;
+using cycamore::RecipeMap;
+
+namespace {
+
+/// The requester of the captured requests and bidder of the captured
+/// responses.
+class Counterparty : public cyclus::Facility {
+ public:
+  Counterparty(cyclus::Context* ctx) : cyclus::Facility(ctx) {}
+  virtual cyclus::Agent* Clone() { return new Counterparty(context()); }
+  virtual void InitInv(cyclus::Inventories& inv) {}
+  virtual cyclus::Inventories SnapshotInv() { return cyclus::Inventories(); }
+  virtual void Tick() {}
+  virtual void Tock() {}
+};
+
+struct Timing {
+  Timing() : n(0), total(0), best(-1) {}
+  void Add(double secs) {
+    n++;
+    total += secs;
+    if (best < 0 || secs < best) {
+      best = secs;
+    }
+  }
+  int n;
+  double total;
+  double best;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  using cycamore::dre::Capture;
+  using cycamore::dre::Exchange;
+  using cycamore::instrument::WallTime;
+
+  if (argc < 3) {
+    std::cerr << "usage: " << argv[0]
+              << " <input file> <capture file> [repetitions]\n";
+    return 1;
+  }
+  int reps = argc > 3 ? std::max(1, std::atoi(argv[3])) : 1;
+  // never overwrite the capture being replayed
+  unsetenv("CYCAMORE_CAPTURE_TIME");
+  cyclus::Logger::ReportLevel() = cyclus::LEV_ERROR;
+
+  try {
+    std::ifstream cf(argv[2]);
+    if (!cf.is_open()) {
+      throw cyclus::IOError(std::string("could not open capture file ") +
+                            argv[2]);
+    }
+    Capture cap = Capture::Read(cf);
+
+    RecipeMap recipes;
+    std::string config = cycamore::ReadPrototype(argv[1], cap.prototype, &recipes);
+    cyclus::MockSim sim(cyclus::AgentSpec(cap.spec), config, cap.time + 1);
+    RecipeMap::iterator rec;
+    for (rec = recipes.begin(); rec != recipes.end(); ++rec) {
+      sim.AddRecipe(rec->first, rec->second);
+    }
+    cyclus::Context* ctx = sim.agent->context();
+    std::string proto = sim.agent->prototype();
+    Counterparty cp(ctx);
+
+    std::map<std::string, Timing> timings;
+    int nreqs = 0;
+    int nbids = 0;
+    int ntrades = 0;
+    int naccepts = 0;
+    for (int i = 0; i < reps; ++i) {
+      cyclus::Agent* a = ctx->CreateAgent<cyclus::Agent>(proto);
+      a->Build(NULL);
+      cyclus::Inventories invs = cycamore::dre::ToInventories(cap);
+      a->InitInv(invs);
+      cyclus::Trader* tr = dynamic_cast<cyclus::Trader*>(a);
+      Exchange ex(cap, &cp);
+
+      double t = WallTime();
+      std::set<cyclus::RequestPortfolio<Material>::Ptr> reqs =
+          tr->GetMatlRequests();
+      timings["GetMatlRequests"].Add(WallTime() - t);
+
+      t = WallTime();
+      std::set<cyclus::BidPortfolio<Material>::Ptr> bids =
+          tr->GetMatlBids(ex.requests());
+      timings["GetMatlBids"].Add(WallTime() - t);
+
+      std::vector<cyclus::Trade<Material> > trades = ex.Trades(bids);
+      std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> > out;
+      t = WallTime();
+      tr->GetMatlTrades(trades, out);
+      timings["GetMatlTrades"].Add(WallTime() - t);
+
+      std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> > in =
+          ex.Responses(reqs);
+      t = WallTime();
+      tr->AcceptMatlTrades(in);
+      timings["AcceptMatlTrades"].Add(WallTime() - t);
+
+      nreqs = 0;
+      cyclus::CommodMap<Material>::type::iterator it;
+      for (it = ex.requests().begin(); it != ex.requests().end(); ++it) {
+        nreqs += it->second.size();
+      }
+      nbids = 0;
+      std::set<cyclus::BidPortfolio<Material>::Ptr>::iterator port;
+      for (port = bids.begin(); port != bids.end(); ++port) {
+        nbids += (*port)->bids().size();
+      }
+      ntrades = trades.size();
+      naccepts = in.size();
+      ctx->DelAgent(a);
+    }
+
+    std::cout << cap.prototype << " (" << cap.spec << ") at time " << cap.time
+              << ": " << nreqs << " requests, " << nbids << " bids, "
+              << ntrades << "/" << cap.trades.size() << " trades, "
+              << naccepts << "/" << cap.accepts.size() << " accepted\n";
+    std::cout << std::left << std::setw(20) << "entry" << std::right
+              << std::setw(8) << "calls" << std::setw(14) << "best_us"
+              << std::setw(14) << "mean_us" << "\n";
+    std::map<std::string, Timing>::iterator tit;
+    for (tit = timings.begin(); tit != timings.end(); ++tit) {
+      const Timing& tm = tit->second;
+      std::cout << std::left << std::setw(20) << tit->first << std::right
+                << std::setw(8) << tm.n << std::fixed << std::setprecision(2)
+                << std::setw(14) << 1e6 * tm.best << std::setw(14)
+                << 1e6 * tm.total / tm.n << "\n";
+    }
+  } catch (cyclus::Error& e) {
+    std::cerr << "error: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -8,6 +8,11 @@
 #include <vector>
 #include <boost/lexical_cast.hpp>
 
+#include "comp_interner.h"
+#include "dre_capture.h"
+#include "instrument.h"
+#include "mutex.h"
+
 namespace cycamore {
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -21,7 +26,9 @@ Enrichment::Enrichment(cyclus::Context* ctx)
       feed_recipe(""),
       product_commod(""),
       tails_commod(""),
-      order_prefs(true){}
+      order_prefs(true),
+      conv_feed_assay_(0),
+      conv_tails_assay_(0) {}
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Enrichment::~Enrichment() {}
@@ -58,6 +65,7 @@ void Enrichment::Build(cyclus::Agent* parent) {
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Enrichment::Tick() {
+  CYCAMORE_TIME("Tick");
   LOG(cyclus::LEV_INFO3, "EnrFac") << prototype() << " is ticking {";
   LOG(cyclus::LEV_INFO3, "EnrFac") << "}";
   current_swu_capacity = SwuCapacity();
@@ -65,6 +73,7 @@ void Enrichment::Tick() {
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Enrichment::Tock() {
+  CYCAMORE_TIME("Tock");
   LOG(cyclus::LEV_INFO3, "EnrFac") << prototype() << " is tocking {";
   LOG(cyclus::LEV_INFO3, "EnrFac") << "}";
 }
@@ -72,6 +81,7 @@ void Enrichment::Tock() {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>
     Enrichment::GetMatlRequests() {
+  CYCAMORE_TIME("GetMatlRequests");
   using cyclus::Material;
   using cyclus::RequestPortfolio;
   using cyclus::Request;
@@ -86,6 +96,7 @@ std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>
     ports.insert(port);
   }
 
+  CYCAMORE_COUNT_REQUESTS(ports);
   return ports;
 }
 
@@ -107,6 +118,7 @@ bool SortBids(
 //  U-235 content
 void Enrichment::AdjustMatlPrefs(
     cyclus::PrefMap<cyclus::Material>::type& prefs) {
+  CYCAMORE_TIME("AdjustMatlPrefs");
 
   using cyclus::Bid;
   using cyclus::Material;
@@ -155,6 +167,8 @@ void Enrichment::AdjustMatlPrefs(
 void Enrichment::AcceptMatlTrades(
     const std::vector< std::pair<cyclus::Trade<cyclus::Material>,
     cyclus::Material::Ptr> >& responses) {
+  CYCAMORE_TIME("AcceptMatlTrades");
+  dre::CaptureAccepts(this, responses);
   // see
   // http://stackoverflow.com/questions/5181183/boostshared-ptr-and-inheritance
   std::vector< std::pair<cyclus::Trade<cyclus::Material>,
@@ -167,6 +181,8 @@ void Enrichment::AcceptMatlTrades(
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Enrichment::GetMatlBids(
     cyclus::CommodMap<cyclus::Material>::type& out_requests){
+  CYCAMORE_TIME("GetMatlBids");
+  dre::CaptureBids(this, out_requests);
   using cyclus::Bid;
   using cyclus::BidPortfolio;
   using cyclus::CapacityConstraint;
@@ -176,12 +192,13 @@ std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Enrichment::GetMatlBids(
 
   std::set<BidPortfolio<Material>::Ptr> ports;
 
-  if ((out_requests.count(tails_commod) > 0) && (tails.quantity() > 0)) {
+  cyclus::CommodMap<Material>::type::const_iterator found =
+      out_requests.find(tails_commod);
+  if ((found != out_requests.end()) && (tails.quantity() > 0)) {
     BidPortfolio<Material>::Ptr tails_port(new BidPortfolio<Material>());
     
-    std::vector<Request<Material>*>& tails_requests =
-      out_requests[tails_commod];
-    std::vector<Request<Material>*>::iterator it;
+    const std::vector<Request<Material>*>& tails_requests = found->second;
+    std::vector<Request<Material>*>::const_iterator it;
     for (it = tails_requests.begin(); it != tails_requests.end(); ++it) {
       Request<Material>* req = *it;
       tails_port->AddBid(req, tails.Peek(), this);
@@ -196,15 +213,21 @@ std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Enrichment::GetMatlBids(
     ports.insert(tails_port);
   }
 
-  if ((out_requests.count(product_commod) > 0) && (inventory.quantity() > 0)) {
+  found = out_requests.find(product_commod);
+  if ((found != out_requests.end()) && (inventory.quantity() > 0)) {
     BidPortfolio<Material>::Ptr commod_port(new BidPortfolio<Material>()); 
     
-    std::vector<Request<Material>*>& commod_requests =
-      out_requests[product_commod];
-    std::vector<Request<Material>*>::iterator it;
+    const std::vector<Request<Material>*>& commod_requests = found->second;
+    std::vector<Request<Material>*>::const_iterator it;
     for (it = commod_requests.begin(); it != commod_requests.end(); ++it) {
       Request<Material>* req = *it;
       Material::Ptr mat = req->target();
+      {
+        // the requester's composition is shared with other bidders, and
+        // cyclus computes its atom basis on first use
+        MutexLock lock(NucDataMutex());
+        mat->comp()->atom();
+      }
       double request_enrich = cyclus::toolkit::UraniumAssay(mat) ;
 
       if (ValidReq(req->target()) && (request_enrich <= max_enrich)) {
@@ -212,10 +235,17 @@ std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Enrichment::GetMatlBids(
         commod_port->AddBid(req, offer, this);
       }
     }
-    Converter<Material>::Ptr sc(new SWUConverter(FeedAssay(), tails_assay));
-    Converter<Material>::Ptr nc(new NatUConverter(FeedAssay(), tails_assay));
-    CapacityConstraint<Material> swu(swu_capacity, sc);
-    CapacityConstraint<Material> natu(inventory.quantity(), nc);
+    // the converters only depend on the assays - keep them until those change
+    double feed_assay = FeedAssay();
+    if (!swu_conv_ || feed_assay != conv_feed_assay_ ||
+        tails_assay != conv_tails_assay_) {
+      swu_conv_.reset(new SWUConverter(feed_assay, tails_assay));
+      natu_conv_.reset(new NatUConverter(feed_assay, tails_assay));
+      conv_feed_assay_ = feed_assay;
+      conv_tails_assay_ = tails_assay;
+    }
+    CapacityConstraint<Material> swu(swu_capacity, swu_conv_);
+    CapacityConstraint<Material> natu(inventory.quantity(), natu_conv_);
     commod_port->AddConstraint(swu);
     commod_port->AddConstraint(natu);
     
@@ -227,6 +257,7 @@ std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Enrichment::GetMatlBids(
 				     << natu.capacity();
     ports.insert(commod_port);
   }
+  CYCAMORE_COUNT_BIDS(ports);
   return ports;
 }
 
@@ -243,6 +274,8 @@ void Enrichment::GetMatlTrades(
     const std::vector< cyclus::Trade<cyclus::Material> >& trades,
     std::vector<std::pair<cyclus::Trade<cyclus::Material>,
     cyclus::Material::Ptr> >& responses) {
+  CYCAMORE_TIME("GetMatlTrades");
+  dre::CaptureTrades(this, trades);
 
   using cyclus::Material;
   using cyclus::Trade;
@@ -329,18 +362,27 @@ void Enrichment::AddMat_(cyclus::Material::Ptr mat) {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 cyclus::Material::Ptr Enrichment::Request_() {
   double qty = std::max(0.0, inventory.capacity() - inventory.quantity());
-  return cyclus::Material::CreateUntracked(qty,
-					   context()->GetRecipe(feed_recipe));
+  targets_.Reset(context()->time());
+  return targets_.Get(qty, context()->GetRecipe(feed_recipe));
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 cyclus::Material::Ptr Enrichment::Offer_(cyclus::Material::Ptr mat) {
+  // offers only depend on the requested material - pooled by its quantity
+  // and composition.
+  offers_.Reset(context()->time());
+  cyclus::Material::Ptr offer = offers_.Find(mat->quantity(), mat->comp());
+  if (offer) {
+    return offer;
+  }
   cyclus::toolkit::MatQuery q(mat);
   cyclus::CompMap comp;
   comp[922350000] = q.atom_frac(922350000);
   comp[922380000] = q.atom_frac(922380000);
-  return cyclus::Material::CreateUntracked(
-           mat->quantity(), cyclus::Composition::CreateFromAtom(comp));
+  offer = CreateUntracked(mat->quantity(),
+                          CompInterner::Instance(context())->Atom(comp));
+  offers_.Put(mat->quantity(), mat->comp(), offer);
+  return offer;
 }
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 cyclus::Material::Ptr Enrichment::Enrich_(
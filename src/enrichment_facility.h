@@ -4,6 +4,7 @@
 #include <string>
 
 #include "cyclus.h"
+#include "untracked_pool.h"
 
 namespace cycamore {
 
@@ -345,6 +346,16 @@ class Enrichment : public cyclus::Facility {
   cyclus::toolkit::ResBuf<cyclus::Material> inventory;  // natural u
   #pragma cyclus var {}
   cyclus::toolkit::ResBuf<cyclus::Material> tails;  // depleted u
+
+  // feed request targets and product offers
+  UntrackedPool targets_;
+  UntrackedPool offers_;
+
+  // bid constraint converters and the feed and tails assays they were made for
+  cyclus::Converter<cyclus::Material>::Ptr swu_conv_;
+  cyclus::Converter<cyclus::Material>::Ptr natu_conv_;
+  double conv_feed_assay_;
+  double conv_tails_assay_;
   
   friend class EnrichmentTest;
   // ---
@@ -10,6 +10,7 @@
 #include "env.h"
 
 #include "enrichment_facility_tests.h"
+#include "parallel_bids.h"
 
 using cyclus::QueryResult;
 using cyclus::Cond;
@@ -555,6 +556,57 @@ TEST_F(EnrichmentTest, ValidReq) {
   EXPECT_NEAR(natuc.convert(target) * mass_frac, natuc.convert(offer), 0.001); 
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(EnrichmentTest, ReusedConverters) {
+  // Tests that the SWU and NatU converters of the product bids are only
+  // remade when the feed assay changes.
+  using cyclus::BidPortfolio;
+  using cyclus::CapacityConstraint;
+  using cyclus::Converter;
+  using cyclus::Request;
+
+  DoAddMat(GetMat(inv_size / 2));
+  cyclus::CompMap p;
+  p[922350000] = 0.05;
+  p[922380000] = 0.95;
+  Material::Ptr target =
+      Material::CreateUntracked(1.0, Composition::CreateFromMass(p));
+  Request<Material>* req =
+      Request<Material>::Create(target, trader, product_commod);
+  cyclus::CommodMap<Material>::type reqs;
+  reqs[product_commod].push_back(req);
+
+  std::set<Converter<Material>::Ptr> convs;
+  for (int i = 0; i < 2; i++) {
+    std::set<BidPortfolio<Material>::Ptr> ports =
+        src_facility->GetMatlBids(reqs);
+    ASSERT_EQ(1, ports.size());
+    const std::set<CapacityConstraint<Material> >& constrs =
+        (*ports.begin())->constraints();
+    std::set<CapacityConstraint<Material> >::const_iterator it;
+    for (it = constrs.begin(); it != constrs.end(); ++it) {
+      convs.insert(it->converter());
+    }
+  }
+  EXPECT_EQ(2, convs.size());
+
+  // feed of another assay changes the converters
+  cyclus::CompMap v;
+  v[922350000] = 0.01;
+  v[922380000] = 0.99;
+  DoAddMat(Material::CreateUntracked(inv_size / 2,
+                                     Composition::CreateFromAtom(v)));
+  std::set<BidPortfolio<Material>::Ptr> ports =
+      src_facility->GetMatlBids(reqs);
+  const std::set<CapacityConstraint<Material> >& constrs =
+      (*ports.begin())->constraints();
+  std::set<CapacityConstraint<Material> >::const_iterator it;
+  for (it = constrs.begin(); it != constrs.end(); ++it) {
+    convs.insert(it->converter());
+  }
+  EXPECT_EQ(4, convs.size());
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST_F(EnrichmentTest, Enrich) {
   // this test asks the facility to enrich a material that results in an amount
@@ -667,6 +719,75 @@ TEST_F(EnrichmentTest, Response) {
   EXPECT_NO_THROW(src_facility->GetMatlTrades(trades, responses));
   EXPECT_EQ(responses.size(), 2);
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(EnrichmentTest, ParallelBids) {
+  // Enrichers bid for at once on many threads make the same bids as ones bid
+  // for one at a time - the requested compositions are shared by all of
+  // them and have no atom basis until the first bid reads it.
+  std::string config =
+    "   <feed_commod>natu</feed_commod> "
+    "   <feed_recipe>natu1</feed_recipe> "
+    "   <product_commod>enr_u</product_commod> "
+    "   <tails_commod>tails</tails_commod> "
+    "   <max_feed_inventory>100</max_feed_inventory> "
+    "   <tails_assay>0.003</tails_assay> ";
+
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Enrichment"), config, 2);
+  sim.AddRecipe("natu1", c_natu1());
+  sim.AddRecipe("leu", c_leu());
+  sim.AddSource("natu").recipe("natu1").Finalize();
+  sim.AddSink("enr_u").recipe("leu").capacity(1).Finalize();
+  sim.Run();
+  Enrichment* enr = dynamic_cast<Enrichment*>(sim.agent);
+  ASSERT_TRUE(enr != NULL);
+  cyclus::Inventories full = enr->SnapshotInv();
+  ASSERT_GT(full["inventory"].size(), 0);
+  ASSERT_GT(full["tails"].size(), 0);
+
+  // two identical sets of enrichers - every third one without tails - one
+  // bid for in parallel and one serially
+  int n = 300;
+  std::vector<Enrichment*> par;
+  std::vector<Enrichment*> ser;
+  for (int i = 0; i < n; i++) {
+    cyclus::Inventories invs = full;
+    if (i % 3 == 0) {
+      invs.erase("tails");
+    }
+    Enrichment* a =
+        enr->context()->CreateAgent<Enrichment>(enr->prototype());
+    a->InitInv(invs);
+    par.push_back(a);
+    Enrichment* b =
+        enr->context()->CreateAgent<Enrichment>(enr->prototype());
+    b->InitInv(invs);
+    ser.push_back(b);
+  }
+
+  cyclus::CommodMap<Material>::type reqs;
+  for (int i = 1; i <= 3; i++) {
+    cyclus::CompMap v;
+    v[922350000] = 0.01 * i;
+    v[922380000] = 1 - 0.01 * i;
+    Material::Ptr target =
+        Material::CreateUntracked(i, Composition::CreateFromMass(v));
+    reqs["enr_u"].push_back(
+        cyclus::Request<Material>::Create(target, enr, "enr_u"));
+  }
+  Material::Ptr tails = Material::CreateUntracked(1, c_nou235());
+  reqs["tails"].push_back(
+      cyclus::Request<Material>::Create(tails, enr, "tails"));
+
+  std::vector<BidSet> par_bids = BidInParallel(par, reqs, 8);
+
+  for (int i = 0; i < n; i++) {
+    BidSet ser_bids = ser[i]->GetMatlBids(reqs);
+    ASSERT_EQ(ser_bids.size(), par_bids[i].size()) << "enricher " << i;
+    EXPECT_EQ(DescribeBids(ser_bids), DescribeBids(par_bids[i]))
+        << "enricher " << i;
+  }
+}
   
 }  // namespace cycamore
 
@@ -1,5 +1,10 @@
 #include "fuel_fab.h"
 
+#include "comp_interner.h"
+#include "dre_capture.h"
+#include "instrument.h"
+#include "mutex.h"
+
 using cyclus::Material;
 using cyclus::Composition;
 using pyne::simple_xs;
@@ -13,12 +18,15 @@ namespace cycamore {
 class FissConverter : public cyclus::Converter<cyclus::Material> {
  public:
   FissConverter(Composition::Ptr c_fill, Composition::Ptr c_fiss,
-                Composition::Ptr c_topup, std::string spectrum)
-      : c_fiss_(c_fiss), c_topup_(c_topup), c_fill_(c_fill), spec_(spectrum) {
-    w_fiss_ = CosiWeight(c_fiss, spectrum);
-    w_fill_ = CosiWeight(c_fill, spectrum);
-    w_topup_ = CosiWeight(c_topup, spectrum);
-  }
+                Composition::Ptr c_topup, double w_fill, double w_fiss,
+                double w_topup, std::string spectrum)
+      : spec_(spectrum),
+        w_fiss_(w_fiss),
+        w_topup_(w_topup),
+        w_fill_(w_fill),
+        c_fiss_(c_fiss),
+        c_fill_(c_fill),
+        c_topup_(c_topup) {}
 
   virtual ~FissConverter() {}
 
@@ -52,12 +60,15 @@ class FissConverter : public cyclus::Converter<cyclus::Material> {
 class FillConverter : public cyclus::Converter<cyclus::Material> {
  public:
   FillConverter(Composition::Ptr c_fill, Composition::Ptr c_fiss,
-                Composition::Ptr c_topup, std::string spectrum)
-      : c_fiss_(c_fiss), c_topup_(c_topup), c_fill_(c_fill), spec_(spectrum) {
-    w_fiss_ = CosiWeight(c_fiss, spectrum);
-    w_fill_ = CosiWeight(c_fill, spectrum);
-    w_topup_ = CosiWeight(c_topup, spectrum);
-  }
+                Composition::Ptr c_topup, double w_fill, double w_fiss,
+                double w_topup, std::string spectrum)
+      : spec_(spectrum),
+        w_fiss_(w_fiss),
+        w_topup_(w_topup),
+        w_fill_(w_fill),
+        c_fiss_(c_fiss),
+        c_fill_(c_fill),
+        c_topup_(c_topup) {}
 
   virtual ~FillConverter() {}
 
@@ -90,12 +101,15 @@ class FillConverter : public cyclus::Converter<cyclus::Material> {
 class TopupConverter : public cyclus::Converter<cyclus::Material> {
  public:
   TopupConverter(Composition::Ptr c_fill, Composition::Ptr c_fiss,
-                 Composition::Ptr c_topup, std::string spectrum)
-      : c_fiss_(c_fiss), c_topup_(c_topup), c_fill_(c_fill), spec_(spectrum) {
-    w_fiss_ = CosiWeight(c_fiss, spectrum);
-    w_fill_ = CosiWeight(c_fill, spectrum);
-    w_topup_ = CosiWeight(c_topup, spectrum);
-  }
+                 Composition::Ptr c_topup, double w_fill, double w_fiss,
+                 double w_topup, std::string spectrum)
+      : spec_(spectrum),
+        w_fiss_(w_fiss),
+        w_topup_(w_topup),
+        w_fill_(w_fill),
+        c_fiss_(c_fiss),
+        c_fill_(c_fill),
+        c_topup_(c_topup) {}
 
   virtual ~TopupConverter() {}
 
@@ -125,8 +139,40 @@ class TopupConverter : public cyclus::Converter<cyclus::Material> {
   Composition::Ptr c_topup_;
 };
 
+namespace {
+
+// Returns an untracked mix of qty1 kg of c1 and qty2 kg of c2 - made of a
+// shared composition so identical mixes of any fuel fab are the same
+// composition.
+Material::Ptr Mix(double qty1, Composition::Ptr c1, double qty2,
+                  Composition::Ptr c2, CompInterner* interner) {
+  if (c1 == c2) {
+    return CreateUntracked(qty1 + qty2, c1);
+  }
+  cyclus::CompMap v1;
+  cyclus::CompMap v2;
+  {
+    MutexLock lock(NucDataMutex());
+    v1 = c1->mass();
+    v2 = c2->mass();
+  }
+  cyclus::compmath::Normalize(&v1, qty1);
+  cyclus::compmath::Normalize(&v2, qty2);
+  return CreateUntracked(qty1 + qty2,
+                         interner->Mass(cyclus::compmath::Add(v1, v2)));
+}
+
+}  // namespace
+
 FuelFab::FuelFab(cyclus::Context* ctx)
-    : cyclus::Facility(ctx), fill_size(0), fiss_size(0), throughput(0) {}
+    : cyclus::Facility(ctx),
+      fill_size(0),
+      fiss_size(0),
+      throughput(0),
+      mix_has_topup_(false),
+      mix_w_fill_(0),
+      mix_w_fiss_(0),
+      mix_w_topup_(0) {}
 
 void FuelFab::EnterNotify() {
   cyclus::Facility::EnterNotify();
@@ -139,11 +185,13 @@ void FuelFab::EnterNotify() {
 }
 
 std::set<cyclus::RequestPortfolio<Material>::Ptr> FuelFab::GetMatlRequests() {
+  CYCAMORE_TIME("GetMatlRequests");
   using cyclus::RequestPortfolio;
 
   std::set<RequestPortfolio<Material>::Ptr> ports;
 
   bool exclusive = false;
+  targets_.Reset(context()->time());
 
   if (fiss.space() > cyclus::eps()) {
     RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
@@ -151,7 +199,7 @@ std::set<cyclus::RequestPortfolio<Material>::Ptr> FuelFab::GetMatlRequests() {
     Material::Ptr m = cyclus::NewBlankMaterial(fiss.space());
     if (!fiss_recipe.empty()) {
       Composition::Ptr c = context()->GetRecipe(fiss_recipe);
-      m = Material::CreateUntracked(fiss.space(), c);
+      m = targets_.Get(fiss.space(), c);
     }
 
     std::vector<cyclus::Request<Material>*> reqs;
@@ -171,7 +219,7 @@ std::set<cyclus::RequestPortfolio<Material>::Ptr> FuelFab::GetMatlRequests() {
     Material::Ptr m = cyclus::NewBlankMaterial(fill.space());
     if (!fill_recipe.empty()) {
       Composition::Ptr c = context()->GetRecipe(fill_recipe);
-      m = Material::CreateUntracked(fill.space(), c);
+      m = targets_.Get(fill.space(), c);
     }
     cyclus::Request<Material>* r =
         port->AddRequest(m, this, fill_commod, fill_pref, exclusive);
@@ -185,7 +233,7 @@ std::set<cyclus::RequestPortfolio<Material>::Ptr> FuelFab::GetMatlRequests() {
     Material::Ptr m = cyclus::NewBlankMaterial(topup.space());
     if (!topup_recipe.empty()) {
       Composition::Ptr c = context()->GetRecipe(topup_recipe);
-      m = Material::CreateUntracked(topup.space(), c);
+      m = targets_.Get(topup.space(), c);
     }
     cyclus::Request<Material>* r =
         port->AddRequest(m, this, topup_commod, topup_pref, exclusive);
@@ -193,6 +241,7 @@ std::set<cyclus::RequestPortfolio<Material>::Ptr> FuelFab::GetMatlRequests() {
     ports.insert(port);
   }
 
+  CYCAMORE_COUNT_REQUESTS(ports);
   return ports;
 }
 
@@ -207,6 +256,8 @@ bool Contains(std::vector<std::string> vec, std::string s) {
 
 void FuelFab::AcceptMatlTrades(const std::vector<
     std::pair<cyclus::Trade<Material>, Material::Ptr> >& responses) {
+  CYCAMORE_TIME("AcceptMatlTrades");
+  dre::CaptureAccepts(this, responses);
   std::vector<std::pair<cyclus::Trade<cyclus::Material>,
                         cyclus::Material::Ptr> >::const_iterator trade;
 
@@ -215,11 +266,15 @@ void FuelFab::AcceptMatlTrades(const std::vector<
     double req_qty = trade->first.request->target()->quantity();
     cyclus::Request<Material>* req = trade->first.request;
     Material::Ptr m = trade->second;
-    if (req_inventories_[req] == "fill") {
+    std::map<cyclus::Request<Material>*, std::string>::const_iterator inv =
+        req_inventories_.find(req);
+    if (inv == req_inventories_.end()) {
+      throw cyclus::ValueError("cycamore::FuelFab was overmatched on requests");
+    } else if (inv->second == "fill") {
       fill.Push(m);
-    } else if (req_inventories_[req] == "topup") {
+    } else if (inv->second == "topup") {
       topup.Push(m);
-    } else if (req_inventories_[req] == "fiss") {
+    } else if (inv->second == "fiss") {
       fiss.Push(m);
     } else {
       throw cyclus::ValueError("cycamore::FuelFab was overmatched on requests");
@@ -230,64 +285,77 @@ void FuelFab::AcceptMatlTrades(const std::vector<
 
 std::set<cyclus::BidPortfolio<Material>::Ptr> FuelFab::GetMatlBids(
     cyclus::CommodMap<Material>::type& commod_requests) {
+  CYCAMORE_TIME("GetMatlBids");
+  dre::CaptureBids(this, commod_requests);
   using cyclus::BidPortfolio;
 
   std::set<BidPortfolio<Material>::Ptr> ports;
-  std::vector<cyclus::Request<Material>*>& reqs = commod_requests[outcommod];
-
+  cyclus::CommodMap<Material>::type::const_iterator found =
+      commod_requests.find(outcommod);
   if (throughput == 0) {
     return ports;
-  } else if (reqs.size() == 0) {
+  } else if (found == commod_requests.end() || found->second.size() == 0) {
     return ports;
   }
+  const std::vector<cyclus::Request<Material>*>& reqs = found->second;
 
-  double w_fill = 0;
   Composition::Ptr
       c_fill;  // no default needed - this is non-optional parameter
   if (fill.count() > 0) {
     c_fill = fill.Peek()->comp();
-    w_fill = CosiWeight(c_fill, spectrum);
   } else {
     c_fill = context()->GetRecipe(fill_recipe);
-    w_fill = CosiWeight(c_fill, spectrum);
   }
 
-  double w_topup = 0;
   Composition::Ptr c_topup = c_fill;
   if (topup.count() > 0) {
     c_topup = topup.Peek()->comp();
-    w_topup = CosiWeight(c_topup, spectrum);
   } else if (!topup_recipe.empty()) {
     c_topup = context()->GetRecipe(topup_recipe);
-    w_topup = CosiWeight(c_topup, spectrum);
   }
 
-  double w_fiss =
-      w_fill;  // this allows trading just fill with no fiss inventory
   Composition::Ptr c_fiss = c_fill;
   if (fiss.count() > 0) {
     c_fiss = fiss.Peek()->comp();
-    w_fiss = CosiWeight(c_fiss, spectrum);
   } else if (!fiss_recipe.empty()) {
     c_fiss = context()->GetRecipe(fiss_recipe);
-    w_fiss = CosiWeight(c_fiss, spectrum);
   }
 
+  // the weights, converters and pooled offers only depend on the fill, fiss
+  // and topup compositions (and whether topup is on hand) - they are only
+  // redone when those change.
+  offers_.Reset(context()->time());
+  bool has_topup = topup.count() > 0;
+  if (c_fill != mix_fill_ || c_fiss != mix_fiss_ || c_topup != mix_topup_ ||
+      has_topup != mix_has_topup_) {
+    Remix(c_fill, c_fiss, c_topup, has_topup);
+  }
+  double w_fill = mix_w_fill_;
+  double w_fiss = mix_w_fiss_;
+  double w_topup = mix_w_topup_;
+
+  CompInterner* interner = CompInterner::Instance(context());
   BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
   for (int j = 0; j < reqs.size(); j++) {
     cyclus::Request<Material>* req = reqs[j];
 
     Composition::Ptr tgt = req->target()->comp();
-    double w_tgt = CosiWeight(tgt, spectrum);
     double tgt_qty = req->target()->quantity();
+    Material::Ptr offer = offers_.Find(tgt_qty, tgt);
+    if (offer) {
+      port->AddBid(req, offer, this, false);
+      continue;
+    }
+
+    double w_tgt = CosiWeight(tgt, spectrum);
     if (ValidWeights(w_fill, w_tgt, w_fiss)) {
       double fiss_frac = HighFrac(w_fill, w_tgt, w_fiss);
       double fill_frac = 1 - fiss_frac;
       fiss_frac = AtomToMassFrac(fiss_frac, c_fiss, c_fill);
       fill_frac = AtomToMassFrac(fill_frac, c_fill, c_fiss);
-      Material::Ptr m1 = Material::CreateUntracked(fiss_frac * tgt_qty, c_fiss);
-      Material::Ptr m2 = Material::CreateUntracked(fill_frac * tgt_qty, c_fill);
-      m1->Absorb(m2);
+      Material::Ptr m1 = Mix(fiss_frac * tgt_qty, c_fiss, fill_frac * tgt_qty,
+                             c_fill, interner);
+      offers_.Put(tgt_qty, tgt, m1);
 
       bool exclusive = false;
       port->AddBid(req, m1, this, exclusive);
@@ -299,30 +367,23 @@ std::set<cyclus::BidPortfolio<Material>::Ptr> FuelFab::GetMatlBids(
       double fiss_frac = 1 - topup_frac;
       fiss_frac = AtomToMassFrac(fiss_frac, c_fiss, c_topup);
       topup_frac = AtomToMassFrac(topup_frac, c_topup, c_fiss);
-      Material::Ptr m1 =
-          Material::CreateUntracked(topup_frac * tgt_qty, c_topup);
-      Material::Ptr m2 = Material::CreateUntracked(fiss_frac * tgt_qty, c_fiss);
-      m1->Absorb(m2);
+      Material::Ptr m1 = Mix(topup_frac * tgt_qty, c_topup,
+                             fiss_frac * tgt_qty, c_fiss, interner);
+      offers_.Put(tgt_qty, tgt, m1);
 
       bool exclusive = false;
       port->AddBid(req, m1, this, exclusive);
     }  // else can't meet the target - don't bid
   }
 
-  cyclus::Converter<Material>::Ptr fissconv(
-      new FissConverter(c_fill, c_fiss, c_topup, spectrum));
-  cyclus::Converter<Material>::Ptr fillconv(
-      new FillConverter(c_fill, c_fiss, c_topup, spectrum));
-  cyclus::Converter<Material>::Ptr topupconv(
-      new TopupConverter(c_fill, c_fiss, c_topup, spectrum));
   // important! - the std::max calls prevent CapacityConstraint throwing a zero
   // cap exception
   cyclus::CapacityConstraint<Material> fissc(std::max(fiss.quantity(), 1e-10),
-                                             fissconv);
+                                             fissconv_);
   cyclus::CapacityConstraint<Material> fillc(std::max(fill.quantity(), 1e-10),
-                                             fillconv);
+                                             fillconv_);
   cyclus::CapacityConstraint<Material> topupc(std::max(topup.quantity(), 1e-10),
-                                              topupconv);
+                                              topupconv_);
   port->AddConstraint(fillc);
   port->AddConstraint(fissc);
   port->AddConstraint(topupc);
@@ -330,13 +391,48 @@ std::set<cyclus::BidPortfolio<Material>::Ptr> FuelFab::GetMatlBids(
   cyclus::CapacityConstraint<Material> cc(throughput);
   port->AddConstraint(cc);
   ports.insert(port);
+  CYCAMORE_COUNT_BIDS(ports);
   return ports;
 }
 
+void FuelFab::Remix(Composition::Ptr c_fill, Composition::Ptr c_fiss,
+                    Composition::Ptr c_topup, bool has_topup) {
+  double w_fill = CosiWeight(c_fill, spectrum);
+  double w_fiss = w_fill;  // this allows trading just fill with no fiss
+  if (c_fiss != c_fill) {
+    w_fiss = CosiWeight(c_fiss, spectrum);
+  }
+  double w_topup = w_fill;
+  if (c_topup == c_fiss) {
+    w_topup = w_fiss;
+  } else if (c_topup != c_fill) {
+    w_topup = CosiWeight(c_topup, spectrum);
+  }
+
+  mix_fill_ = c_fill;
+  mix_fiss_ = c_fiss;
+  mix_topup_ = c_topup;
+  mix_has_topup_ = has_topup;
+  mix_w_fill_ = w_fill;
+  mix_w_fiss_ = w_fiss;
+  // no topup to bid with unless there is topup inventory or a recipe for it
+  mix_w_topup_ = (has_topup || !topup_recipe.empty()) ? w_topup : 0;
+
+  fissconv_.reset(new FissConverter(c_fill, c_fiss, c_topup, w_fill, w_fiss,
+                                    w_topup, spectrum));
+  fillconv_.reset(new FillConverter(c_fill, c_fiss, c_topup, w_fill, w_fiss,
+                                    w_topup, spectrum));
+  topupconv_.reset(new TopupConverter(c_fill, c_fiss, c_topup, w_fill, w_fiss,
+                                      w_topup, spectrum));
+  offers_.Clear();
+}
+
 void FuelFab::GetMatlTrades(
     const std::vector<cyclus::Trade<Material> >& trades,
     std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
         responses) {
+  CYCAMORE_TIME("GetMatlTrades");
+  dre::CaptureTrades(this, trades);
   using cyclus::Trade;
 
   double w_fill = 0;
@@ -425,6 +521,8 @@ extern "C" cyclus::Agent* ConstructFuelFab(cyclus::Context* ctx) {
 // material/mixing fractions will also be atom-based naturally and will need
 // to be converted to mass-based for actual material object mixing.
 double CosiWeight(cyclus::Composition::Ptr c, const std::string& spectrum) {
+  // also guards the cross sections cached below, shared by all fuel fabs
+  MutexLock lock(NucDataMutex());
   cyclus::CompMap cm = c->atom();
   cyclus::compmath::Normalize(&cm);
 
@@ -588,6 +686,7 @@ double CosiWeight(cyclus::Composition::Ptr c, const std::string& spectrum) {
 // corresponding compositions c1 and c2.
 double AtomToMassFrac(double atomfrac, Composition::Ptr c1,
                       Composition::Ptr c2) {
+  MutexLock lock(NucDataMutex());
   cyclus::CompMap n1 = c1->atom();
   cyclus::CompMap n2 = c2->atom();
   cyclus::compmath::Normalize(&n1, atomfrac);
@@ -3,6 +3,7 @@
 
 #include <string>
 #include "cyclus.h"
+#include "untracked_pool.h"
 
 namespace cycamore {
 
@@ -224,6 +225,26 @@ class FuelFab : public cyclus::Facility {
   // intra-time-step state - no need to be a state var
   // map<request, inventory name>
   std::map<cyclus::Request<cyclus::Material>*, std::string> req_inventories_;
+
+  /// Recomputes the mixing weights and bid constraint converters for new
+  /// fill, fiss and topup compositions and drops the pooled offers.
+  void Remix(cyclus::Composition::Ptr c_fill, cyclus::Composition::Ptr c_fiss,
+             cyclus::Composition::Ptr c_topup, bool has_topup);
+
+  // request targets and mixed bid offers, and the fill, fiss and topup
+  // compositions the pooled offers, weights and converters were made from.
+  UntrackedPool targets_;
+  UntrackedPool offers_;
+  cyclus::Composition::Ptr mix_fill_;
+  cyclus::Composition::Ptr mix_fiss_;
+  cyclus::Composition::Ptr mix_topup_;
+  bool mix_has_topup_;
+  double mix_w_fill_;
+  double mix_w_fiss_;
+  double mix_w_topup_;
+  cyclus::Converter<cyclus::Material>::Ptr fissconv_;
+  cyclus::Converter<cyclus::Material>::Ptr fillconv_;
+  cyclus::Converter<cyclus::Material>::Ptr topupconv_;
 };
 
 double CosiWeight(cyclus::Composition::Ptr c, const std::string& spectrum);
@@ -2,7 +2,9 @@
 
 #include <gtest/gtest.h>
 #include <sstream>
+#include "alloc_counter.h"
 #include "cyclus.h"
+#include "parallel_bids.h"
 
 using pyne::nucname::id;
 using cyclus::Composition;
@@ -121,6 +123,33 @@ TEST(FuelFabTests, CosiWeight) {
   EXPECT_GT(w_therm, w_fast);
 }
 
+TEST(FuelFabTests, CosiWeightAllocs) {
+  cyclus::Env::SetNucDataPath();
+  Composition::Ptr c = c_mox();
+  std::string thermal = "thermal";
+  std::string fast = "fission_spectrum_ave";
+
+  // fill the cross section caches and the composition's atom fractions
+  CosiWeight(c, thermal);
+  CosiWeight(c, fast);
+
+  // only the normalized copy of the composition should be allocated
+  long nnucs = c->atom().size();
+  EXPECT_ALLOCS_LE(nnucs, CosiWeight(c, thermal));
+  EXPECT_ALLOCS_LE(nnucs, CosiWeight(c, fast));
+}
+
+TEST(FuelFabTests, AtomToMassFracAllocs) {
+  cyclus::Env::SetNucDataPath();
+  Composition::Ptr c1 = c_pustream();
+  Composition::Ptr c2 = c_natu();
+  AtomToMassFrac(0.1, c1, c2);
+
+  // only the normalized copies of both compositions should be allocated
+  long nnucs = c1->atom().size() + c2->atom().size();
+  EXPECT_ALLOCS_LE(nnucs, AtomToMassFrac(0.1, c1, c2));
+}
+
 TEST(FuelFabTests, CosiWeight_Mixed) {
   double w_fill = CosiWeight(c_natu(), "thermal");
   double w_fiss = CosiWeight(c_pustream(), "thermal");
@@ -487,6 +516,110 @@ TEST(FuelFabTests, ThroughputLimit) {
   EXPECT_DOUBLE_EQ(simdur-1, stmt->GetDouble(0));
 }
 
+// Bidding must treat the request map shared by all bidders as read-only.
+TEST(FuelFabTests, BidsLeaveRequestsUnchanged) {
+  std::string config =
+     "<fill_commod>anything</fill_commod>"
+     "<fill_recipe>natu</fill_recipe>"
+     "<fill_size>100</fill_size>"
+     ""
+     "<fiss_commods> <val>anything</val> </fiss_commods>"
+     "<fiss_recipe>pustream</fiss_recipe>"
+     "<fiss_size>100</fiss_size>"
+     ""
+     "<outcommod>recyclefuel</outcommod>"
+     "<spectrum>thermal</spectrum>"
+     "<throughput>3</throughput>"
+     ;
+
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:FuelFab"), config, 2);
+  sim.AddSource("anything").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("pustream", c_pustream());
+  sim.AddRecipe("natu", c_natu());
+  sim.Run();
+  FuelFab* fab = dynamic_cast<FuelFab*>(sim.agent);
+  ASSERT_TRUE(fab != NULL);
+
+  Material::Ptr target = Material::CreateUntracked(1, c_uox());
+  cyclus::CommodMap<Material>::type reqs;
+  reqs["other"].push_back(
+      cyclus::Request<Material>::Create(target, fab, "other"));
+
+  EXPECT_TRUE(fab->GetMatlBids(reqs).empty());
+  ASSERT_EQ(1, reqs.size());
+  EXPECT_EQ(1, reqs["other"].size());
+  EXPECT_EQ(0, reqs.count("recyclefuel"));
+}
+
+// Bids of many fuel fabs made on a pool of threads at once must be the same
+// as those made one fab at a time - mixing weights use cross sections and
+// compositions shared by all fabs.
+TEST(FuelFabTests, ParallelBids) {
+  std::string config =
+     "<fill_commod>natu</fill_commod>"
+     "<fill_recipe>natu</fill_recipe>"
+     "<fill_size>100</fill_size>"
+     ""
+     "<fiss_commods> <val>pustream</val> </fiss_commods>"
+     "<fiss_recipe>pustream</fiss_recipe>"
+     "<fiss_size>100</fiss_size>"
+     ""
+     "<outcommod>recyclefuel</outcommod>"
+     "<spectrum>thermal</spectrum>"
+     "<throughput>100</throughput>"
+     ;
+
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:FuelFab"), config, 2);
+  sim.AddSource("pustream").Finalize();
+  sim.AddSource("natu").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("pustream", c_pustream());
+  sim.AddRecipe("natu", c_natu());
+  sim.Run();
+  FuelFab* fab = dynamic_cast<FuelFab*>(sim.agent);
+  ASSERT_TRUE(fab != NULL);
+  cyclus::Inventories full = fab->SnapshotInv();
+  ASSERT_GT(full["fill"].size(), 0);
+  ASSERT_GT(full["fiss"].size(), 0);
+
+  // two identical sets of fabs - every third one without fissile stock - one
+  // bid for in parallel and one serially
+  int n = 300;
+  std::vector<FuelFab*> par;
+  std::vector<FuelFab*> ser;
+  for (int i = 0; i < n; i++) {
+    cyclus::Inventories invs = full;
+    if (i % 3 == 0) {
+      invs.erase("fiss");
+    }
+    FuelFab* a = fab->context()->CreateAgent<FuelFab>(fab->prototype());
+    a->InitInv(invs);
+    par.push_back(a);
+    FuelFab* b = fab->context()->CreateAgent<FuelFab>(fab->prototype());
+    b->InitInv(invs);
+    ser.push_back(b);
+  }
+
+  cyclus::CommodMap<Material>::type reqs;
+  for (int i = 1; i <= 3; i++) {
+    Material::Ptr target = Material::CreateUntracked(i, c_uox());
+    reqs["recyclefuel"].push_back(
+        cyclus::Request<Material>::Create(target, fab, "recyclefuel"));
+  }
+
+  std::vector<BidSet> par_bids = BidInParallel(par, reqs, 8);
+
+  for (int i = 0; i < n; i++) {
+    BidSet ser_bids = ser[i]->GetMatlBids(reqs);
+    ASSERT_EQ(ser_bids.size(), par_bids[i].size()) << "fab " << i;
+    EXPECT_EQ(DescribeBids(ser_bids), DescribeBids(par_bids[i]))
+        << "fab " << i;
+  }
+  EXPECT_EQ(1, reqs.size());
+  EXPECT_EQ(3, reqs["recyclefuel"].size());
+}
+
 // supplied fuel has proper equivalence weights as requested.
 TEST(FuelFabTests, CorrectMixing) {
   std::string config = 
@@ -0,0 +1,149 @@
+#include "instrument.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sys/time.h>
+
+namespace cycamore {
+namespace instrument {
+
+namespace {
+
+int ColWidth(const std::string& name) {
+  return std::max(static_cast<int>(name.size()), 8) + 2;
+}
+
+}  // namespace
+
+Registry* Registry::Instance() {
+  static Registry reg;
+  return &reg;
+}
+
+Registry::~Registry() {
+  if (!times_.empty() || !counts_.empty()) {
+    Dump();
+  }
+}
+
+void Registry::AddTime(int t, const std::string& proto,
+                       const std::string& name, double secs) {
+  MutexLock lock(&mu_);
+  Stat& s = times_[Key(t, std::make_pair(proto, name))];
+  s.n++;
+  s.secs += secs;
+}
+
+void Registry::AddCount(int t, const std::string& proto,
+                        const std::string& name, long n) {
+  MutexLock lock(&mu_);
+  Stat& s = counts_[Key(t, std::make_pair(proto, name))];
+  s.n += n;
+}
+
+void Registry::Clear() {
+  MutexLock lock(&mu_);
+  times_.clear();
+  counts_.clear();
+}
+
+void Registry::Write(std::ostream& os) const {
+  typedef std::pair<std::string, std::string> Name;
+  std::map<Name, Stat> tot;
+  StatMap::const_iterator it;
+  for (it = times_.begin(); it != times_.end(); ++it) {
+    Stat& s = tot[it->first.second];
+    s.n += it->second.n;
+    s.secs += it->second.secs;
+  }
+
+  os << "# cycamore entry point timings - totals\n";
+  os << std::left << std::setw(24) << "prototype" << std::setw(20)
+     << "entry" << std::right << std::setw(10) << "calls" << std::setw(14)
+     << "total_s" << std::setw(12) << "mean_us" << "\n";
+  std::map<Name, Stat>::iterator tit;
+  for (tit = tot.begin(); tit != tot.end(); ++tit) {
+    const Stat& s = tit->second;
+    os << std::left << std::setw(24) << tit->first.first << std::setw(20)
+       << tit->first.second << std::right << std::setw(10) << s.n
+       << std::setw(14) << std::fixed << std::setprecision(6) << s.secs
+       << std::setw(12) << std::setprecision(2)
+       << (s.n > 0 ? 1e6 * s.secs / s.n : 0) << "\n";
+  }
+
+  os << "# cycamore entry point timings - per time step\n";
+  os << std::left << std::setw(8) << "time" << std::setw(24) << "prototype"
+     << std::setw(20) << "entry" << std::right << std::setw(10) << "calls"
+     << std::setw(14) << "total_s" << "\n";
+  for (it = times_.begin(); it != times_.end(); ++it) {
+    os << std::left << std::setw(8) << it->first.first << std::setw(24)
+       << it->first.second.first << std::setw(20) << it->first.second.second
+       << std::right << std::setw(10) << it->second.n << std::setw(14)
+       << std::setprecision(6) << it->second.secs << "\n";
+  }
+
+  if (counts_.empty()) {
+    return;
+  }
+
+  // pivot the counters into one row per time step and prototype
+  std::set<std::string> cols;
+  std::map<std::pair<int, std::string>, std::map<std::string, long> > rows;
+  for (it = counts_.begin(); it != counts_.end(); ++it) {
+    cols.insert(it->first.second.second);
+    rows[std::make_pair(it->first.first, it->first.second.first)]
+        [it->first.second.second] += it->second.n;
+  }
+
+  os << "# cycamore counters - per time step\n";
+  os << std::left << std::setw(8) << "time" << std::setw(24) << "prototype"
+     << std::right;
+  std::set<std::string>::iterator cit;
+  for (cit = cols.begin(); cit != cols.end(); ++cit) {
+    os << std::setw(ColWidth(*cit)) << *cit;
+  }
+  os << "\n";
+  std::map<std::pair<int, std::string>,
+           std::map<std::string, long> >::iterator rit;
+  for (rit = rows.begin(); rit != rows.end(); ++rit) {
+    os << std::left << std::setw(8) << rit->first.first << std::setw(24)
+       << rit->first.second << std::right;
+    for (cit = cols.begin(); cit != cols.end(); ++cit) {
+      std::map<std::string, long>::iterator v = rit->second.find(*cit);
+      long n = v == rit->second.end() ? 0 : v->second;
+      os << std::setw(ColWidth(*cit)) << n;
+    }
+    os << "\n";
+  }
+}
+
+void Registry::Dump() const {
+  const char* fname = std::getenv("CYCAMORE_INSTRUMENT_FILE");
+  if (fname == NULL || std::string(fname).empty()) {
+    Write(std::cerr);
+    return;
+  }
+  std::ofstream f(fname);
+  Write(f);
+}
+
+double WallTime() {
+  timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+ScopedTimer::ScopedTimer(cyclus::Agent* a, const char* name)
+    : agent_(a), name_(name), start_(WallTime()) {}
+
+ScopedTimer::~ScopedTimer() {
+  Registry::Instance()->AddTime(agent_->context()->time(),
+                                agent_->prototype(), name_,
+                                WallTime() - start_);
+}
+
+}  // namespace instrument
+}  // namespace cycamore
@@ -0,0 +1,164 @@
+#ifndef CYCAMORE_SRC_INSTRUMENT_H_
+#define CYCAMORE_SRC_INSTRUMENT_H_
+
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+
+#include "cyclus.h"
+#include "mutex.h"
+
+/// @file instrument.h
+///
+/// Opt-in timers and counters for the hot entry points of the cycamore
+/// archetypes (Tick, Tock and the DRE callbacks).  Archetypes mark their entry
+/// points with the CYCAMORE_TIME and CYCAMORE_COUNT macros and report the size
+/// of the portfolios they hand to the DRE with CYCAMORE_COUNT_REQUESTS and
+/// CYCAMORE_COUNT_BIDS.  Unless cycamore is built with the CYCAMORE_INSTRUMENT
+/// cmake option, the macros expand to nothing and cost nothing.  When enabled,
+/// timings and counts are aggregated per prototype and per time step and
+/// written out as tables when the simulation process exits - to the file named
+/// by the CYCAMORE_INSTRUMENT_FILE environment variable if it is set and to
+/// stderr otherwise.
+
+#ifdef CYCAMORE_INSTRUMENT
+#define CYCAMORE_TIME_CAT_(a, b) a##b
+#define CYCAMORE_TIME_NAME_(line) CYCAMORE_TIME_CAT_(cycamore_timer_, line)
+/// Times the rest of the enclosing scope as entry point "name" of this agent.
+#define CYCAMORE_TIME(name) \
+  cycamore::instrument::ScopedTimer CYCAMORE_TIME_NAME_(__LINE__)(this, name)
+/// Adds n to the counter "name" of this agent for the current time step.
+#define CYCAMORE_COUNT(name, n) \
+  cycamore::instrument::Registry::Instance()->AddCount( \
+      this->context()->time(), this->prototype(), name, n)
+/// Counts the portfolios, requests and constraints in a set of request
+/// portfolios submitted by this agent.
+#define CYCAMORE_COUNT_REQUESTS(ports) \
+  cycamore::instrument::CountRequests(this, ports)
+/// Counts the portfolios, bids and constraints in a set of bid portfolios
+/// submitted by this agent.
+#define CYCAMORE_COUNT_BIDS(ports) \
+  cycamore::instrument::CountBids(this, ports)
+#else
+#define CYCAMORE_TIME(name)
+#define CYCAMORE_COUNT(name, n)
+#define CYCAMORE_COUNT_REQUESTS(ports)
+#define CYCAMORE_COUNT_BIDS(ports)
+#endif
+
+namespace cycamore {
+namespace instrument {
+
+/// Accumulated calls and wall time of a single entry point (or the total of a
+/// single counter).
+struct Stat {
+  Stat() : n(0), secs(0) {}
+  long n;
+  double secs;
+};
+
+/// Process-wide store of timings and counters keyed on time step, prototype
+/// and entry point/counter name.  Agents may record into it from several
+/// threads at once.
+class Registry {
+ public:
+  /// (time step, prototype, name)
+  typedef std::pair<int, std::pair<std::string, std::string> > Key;
+  typedef std::map<Key, Stat> StatMap;
+
+  /// Returns the registry that the CYCAMORE_TIME and CYCAMORE_COUNT macros
+  /// record into.
+  static Registry* Instance();
+
+  Registry() {}
+
+  /// Writes the tables out (see Dump) if anything was recorded.
+  ~Registry();
+
+  /// Adds a call taking secs seconds to entry point name of prototype proto
+  /// at time step t.
+  void AddTime(int t, const std::string& proto, const std::string& name,
+               double secs);
+
+  /// Adds n to counter name of prototype proto at time step t.
+  void AddCount(int t, const std::string& proto, const std::string& name,
+                long n);
+
+  /// Writes a table of totals per prototype and entry point followed by a
+  /// table of per time step values to os.  Counters are written as a single
+  /// table with one row per time step and prototype and one column per
+  /// counter.
+  void Write(std::ostream& os) const;
+
+  /// Writes the tables to CYCAMORE_INSTRUMENT_FILE or stderr.
+  void Dump() const;
+
+  /// Discards everything recorded so far.
+  void Clear();
+
+  inline const StatMap& times() const { return times_; }
+  inline const StatMap& counts() const { return counts_; }
+
+ private:
+  StatMap times_;
+  StatMap counts_;
+  Mutex mu_;
+};
+
+/// Adds the number of portfolios (req_ports), requests (requests) and
+/// capacity constraints (req_constraints) in ports to agent a's counters.
+template <class PortSet>
+void CountRequests(cyclus::Agent* a, const PortSet& ports) {
+  long nreqs = 0;
+  long ncons = 0;
+  typename PortSet::const_iterator it;
+  for (it = ports.begin(); it != ports.end(); ++it) {
+    nreqs += (*it)->requests().size();
+    ncons += (*it)->constraints().size();
+  }
+  Registry* reg = Registry::Instance();
+  int t = a->context()->time();
+  reg->AddCount(t, a->prototype(), "req_ports", ports.size());
+  reg->AddCount(t, a->prototype(), "requests", nreqs);
+  reg->AddCount(t, a->prototype(), "req_constraints", ncons);
+}
+
+/// Adds the number of portfolios (bid_ports), bids (bids) and capacity
+/// constraints (bid_constraints) in ports to agent a's counters.
+template <class PortSet>
+void CountBids(cyclus::Agent* a, const PortSet& ports) {
+  long nbids = 0;
+  long ncons = 0;
+  typename PortSet::const_iterator it;
+  for (it = ports.begin(); it != ports.end(); ++it) {
+    nbids += (*it)->bids().size();
+    ncons += (*it)->constraints().size();
+  }
+  Registry* reg = Registry::Instance();
+  int t = a->context()->time();
+  reg->AddCount(t, a->prototype(), "bid_ports", ports.size());
+  reg->AddCount(t, a->prototype(), "bids", nbids);
+  reg->AddCount(t, a->prototype(), "bid_constraints", ncons);
+}
+
+/// Returns a monotonically increasing wall clock time in seconds.
+double WallTime();
+
+/// Records the wall time between its construction and destruction as a call
+/// to an agent's entry point.
+class ScopedTimer {
+ public:
+  ScopedTimer(cyclus::Agent* a, const char* name);
+  ~ScopedTimer();
+
+ private:
+  cyclus::Agent* agent_;
+  const char* name_;
+  double start_;
+};
+
+}  // namespace instrument
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_INSTRUMENT_H_
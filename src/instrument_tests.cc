@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <vector>
+
+#include "instrument.h"
+
+namespace cycamore {
+namespace instrumenttests {
+
+using instrument::Registry;
+using instrument::Stat;
+
+TEST(InstrumentTests, AggregatesPerStep) {
+  Registry reg;
+  reg.AddTime(0, "lwr", "Tick", 1.0);
+  reg.AddTime(0, "lwr", "Tick", 2.0);
+  reg.AddTime(1, "lwr", "Tick", 4.0);
+  reg.AddTime(0, "enr", "Tick", 8.0);
+
+  const Registry::StatMap& times = reg.times();
+  ASSERT_EQ(3, times.size());
+  Stat s = times.find(Registry::Key(0, std::make_pair("lwr", "Tick")))->second;
+  EXPECT_EQ(2, s.n);
+  EXPECT_DOUBLE_EQ(3.0, s.secs);
+  s = times.find(Registry::Key(1, std::make_pair("lwr", "Tick")))->second;
+  EXPECT_EQ(1, s.n);
+  EXPECT_DOUBLE_EQ(4.0, s.secs);
+
+  reg.AddCount(3, "lwr", "bids", 5);
+  reg.AddCount(3, "lwr", "bids", 7);
+  s = reg.counts().find(Registry::Key(3, std::make_pair("lwr", "bids")))->second;
+  EXPECT_EQ(12, s.n);
+  reg.Clear();
+}
+
+TEST(InstrumentTests, WriteTable) {
+  Registry reg;
+  reg.AddTime(0, "lwr", "GetMatlBids", 1.0);
+  reg.AddTime(1, "lwr", "GetMatlBids", 3.0);
+  reg.AddCount(1, "lwr", "bids", 2);
+
+  std::stringstream ss;
+  reg.Write(ss);
+  std::string tbl = ss.str();
+  reg.Clear();
+
+  // one totals row, two per-step rows and one counter row
+  EXPECT_NE(std::string::npos, tbl.find("totals"));
+  EXPECT_NE(std::string::npos, tbl.find("per time step"));
+  EXPECT_NE(std::string::npos, tbl.find("counters"));
+
+  std::stringstream rows(tbl);
+  std::string line;
+  int nbids = 0;
+  while (std::getline(rows, line)) {
+    if (line.find("GetMatlBids") != std::string::npos) {
+      nbids++;
+    }
+  }
+  EXPECT_EQ(3, nbids);
+  EXPECT_NE(std::string::npos, tbl.find("2000000.00"))
+      << "mean time per call should be 2 s for the totals row";
+}
+
+TEST(InstrumentTests, CounterTable) {
+  Registry reg;
+  reg.AddCount(0, "lwr", "bids", 4);
+  reg.AddCount(0, "lwr", "bid_ports", 2);
+  reg.AddCount(0, "enr", "requests", 1);
+  reg.AddCount(1, "lwr", "bids", 3);
+
+  std::stringstream ss;
+  reg.Write(ss);
+  std::string tbl = ss.str();
+  reg.Clear();
+
+  std::string counters = tbl.substr(tbl.find("# cycamore counters"));
+  std::stringstream rows(counters);
+  std::string line;
+  std::getline(rows, line);  // title
+
+  // one column per counter, missing counters are zero
+  std::string name;
+  std::getline(rows, line);
+  std::stringstream hdr(line);
+  std::vector<std::string> cols;
+  while (hdr >> name) {
+    cols.push_back(name);
+  }
+  ASSERT_EQ(5, cols.size());
+  EXPECT_EQ("time", cols[0]);
+  EXPECT_EQ("prototype", cols[1]);
+  EXPECT_EQ("bid_ports", cols[2]);
+  EXPECT_EQ("bids", cols[3]);
+  EXPECT_EQ("requests", cols[4]);
+
+  // one row per time step and prototype
+  int t;
+  long bid_ports, bids, reqs;
+  std::getline(rows, line);
+  std::stringstream(line) >> t >> name >> bid_ports >> bids >> reqs;
+  EXPECT_EQ(0, t);
+  EXPECT_EQ("enr", name);
+  EXPECT_EQ(0, bid_ports);
+  EXPECT_EQ(0, bids);
+  EXPECT_EQ(1, reqs);
+  std::getline(rows, line);
+  std::stringstream(line) >> t >> name >> bid_ports >> bids >> reqs;
+  EXPECT_EQ(0, t);
+  EXPECT_EQ("lwr", name);
+  EXPECT_EQ(2, bid_ports);
+  EXPECT_EQ(4, bids);
+  EXPECT_EQ(0, reqs);
+  std::getline(rows, line);
+  std::stringstream(line) >> t >> name >> bid_ports >> bids >> reqs;
+  EXPECT_EQ(1, t);
+  EXPECT_EQ(3, bids);
+  EXPECT_FALSE(std::getline(rows, line));
+}
+
+}  // namespace instrumenttests
+}  // namespace cycamore
@@ -0,0 +1,62 @@
+#ifndef CYCAMORE_SRC_MUTEX_H_
+#define CYCAMORE_SRC_MUTEX_H_
+
+#include <pthread.h>
+
+namespace cycamore {
+
+/// A mutex guarding process-wide state shared by agents - such as the caches
+/// that archetypes fill while bidding, which may run for several agents at
+/// once.
+class Mutex {
+ public:
+  Mutex() { pthread_mutex_init(&mu_, NULL); }
+  ~Mutex() { pthread_mutex_destroy(&mu_); }
+
+  inline void Lock() { pthread_mutex_lock(&mu_); }
+  inline void Unlock() { pthread_mutex_unlock(&mu_); }
+
+ private:
+  // not copyable
+  Mutex(const Mutex&);
+  Mutex& operator=(const Mutex&);
+
+  pthread_mutex_t mu_;
+};
+
+/// Holds a Mutex locked for the rest of the enclosing scope.
+class MutexLock {
+ public:
+  explicit MutexLock(Mutex* mu) : mu_(mu) { mu_->Lock(); }
+  ~MutexLock() { mu_->Unlock(); }
+
+ private:
+  // not copyable
+  MutexLock(const MutexLock&);
+  MutexLock& operator=(const MutexLock&);
+
+  Mutex* mu_;
+};
+
+/// Guards the resource and composition id counters of cyclus, which are
+/// plain statics.  Materials and compositions made while agents may be
+/// bidding at once are made with it held.  Only NucDataMutex may be taken
+/// while it is held.
+inline Mutex* IdMutex() {
+  static Mutex mu;
+  return &mu;
+}
+
+/// Guards pyne's nuclear data, which pyne loads on first use, and the
+/// composition bases cyclus computes from it on first use - e.g. the atom
+/// fractions of a recipe defined by mass, which is shared by every agent
+/// using the recipe.  Taken before reading a basis that may not be computed
+/// yet.  No other lock is taken while it is held.
+inline Mutex* NucDataMutex() {
+  static Mutex mu;
+  return &mu;
+}
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_MUTEX_H_
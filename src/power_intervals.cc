@@ -0,0 +1,157 @@
+#include "power_intervals.h"
+
+#include <utility>
+
+#include <boost/uuid/nil_generator.hpp>
+
+namespace cycamore {
+
+namespace {
+
+void WriteInterval(cyclus::Agent* a, int start, int end, double value) {
+  a->context()->NewDatum("PowerIntervals")
+      ->AddVal("AgentId", a->id())
+      ->AddVal("Start", start)
+      ->AddVal("End", end)
+      ->AddVal("Value", value)
+      ->Record();
+}
+
+}  // namespace
+
+void JoinRegionPower(cyclus::Agent* a) {
+  RegionPower::Instance(a->context())->Join(a, a->context()->time());
+}
+
+void RecordPowerInterval(cyclus::Agent* a, double p, int* start,
+                         double* value) {
+  int t = a->context()->time();
+  if (*start < 0) {
+    *start = t;
+    *value = p;
+  } else if (p != *value) {
+    WriteInterval(a, *start, t - 1, *value);
+    *start = t;
+    *value = p;
+  }
+  RegionPower::Instance(a->context())->Update(a, t, p);
+
+  if (t == a->context()->sim_info().duration - 1) {
+    WriteInterval(a, *start, t, *value);
+    RegionPower::Instance(a->context())->Finish(a);
+  }
+}
+
+void ClosePowerInterval(cyclus::Agent* a, int* start, double* value) {
+  int t = a->context()->time();
+  if (*start < 0 || t == a->context()->sim_info().duration - 1) {
+    // nothing recorded yet or already written out
+    return;
+  }
+  WriteInterval(a, *start, t, *value);
+  RegionPower::Instance(a->context())->Remove(a, t);
+  *start = -1;
+}
+
+RegionPower::RegionPower() : sim_(boost::uuids::nil_uuid()) {}
+
+RegionPower* RegionPower::Instance(cyclus::Context* ctx) {
+  static RegionPower totals;
+  if (ctx->sim_id() != totals.sim_) {
+    // totals left open by a simulation that did not run to its end
+    totals.totals_.clear();
+    totals.sim_ = ctx->sim_id();
+  }
+  return &totals;
+}
+
+void RegionPower::Join(cyclus::Agent* a, int t) {
+  cyclus::Agent* r = Region(a);
+  if (r == NULL) {
+    return;
+  }
+  Total& tot = totals_[r->id()];
+  Advance(r, &tot, t);
+  tot.members.insert(std::make_pair(a->id(), 0.0));
+}
+
+void RegionPower::Update(cyclus::Agent* a, int t, double p) {
+  cyclus::Agent* r = Region(a);
+  if (r == NULL) {
+    return;
+  }
+  Total& tot = totals_[r->id()];
+  Advance(r, &tot, t);
+  double& counted = tot.members[a->id()];
+  tot.next += p - counted;
+  counted = p;
+}
+
+void RegionPower::Finish(cyclus::Agent* a) {
+  cyclus::Agent* r = Region(a);
+  if (r == NULL) {
+    return;
+  }
+  int k = r->id();
+  Total& tot = totals_[k];
+  tot.n_done++;
+  if (tot.n_done < static_cast<int>(tot.members.size())) {
+    return;
+  }
+  int t = a->context()->time();
+  Advance(r, &tot, t + 1);
+  Write(r, tot.start, t, tot.value);
+  totals_.erase(k);
+}
+
+void RegionPower::Remove(cyclus::Agent* a, int t) {
+  cyclus::Agent* r = Region(a);
+  if (r == NULL) {
+    return;
+  }
+  int k = r->id();
+  Total& tot = totals_[k];
+  Advance(r, &tot, t + 1);
+  tot.next -= tot.members[a->id()];
+  tot.members.erase(a->id());
+  if (tot.members.empty()) {
+    Write(r, tot.start, t, tot.value);
+    totals_.erase(k);
+  }
+}
+
+cyclus::Agent* RegionPower::Region(cyclus::Agent* a) {
+  for (cyclus::Agent* p = a->parent(); p != NULL; p = p->parent()) {
+    if (p->kind() == "Region") {
+      return p;
+    }
+  }
+  return NULL;
+}
+
+void RegionPower::Advance(cyclus::Agent* r, Total* tot, int t) {
+  if (t <= tot->now) {
+    return;
+  }
+  // settle the sum of the previous time step
+  if (tot->now >= 0 && (tot->start < 0 || tot->next != tot->value)) {
+    Write(r, tot->start, tot->now - 1, tot->value);
+    tot->start = tot->now;
+    tot->value = tot->next;
+  }
+  tot->now = t;
+}
+
+void RegionPower::Write(cyclus::Agent* r, int start, int end, double value) {
+  if (start < 0 || end < start) {
+    return;
+  }
+  r->context()->NewDatum("RegionPowerIntervals")
+      ->AddVal("RegionId", r->id())
+      ->AddVal("Start", start)
+      ->AddVal("End", end)
+      ->AddVal("Value", value)
+      ->Record();
+}
+
+}  // namespace cycamore
@@ -0,0 +1,98 @@
+#ifndef CYCAMORE_SRC_POWER_INTERVALS_H_
+#define CYCAMORE_SRC_POWER_INTERVALS_H_
+
+#include <map>
+
+#include <boost/uuid/uuid.hpp>
+
+#include "cyclus.h"
+
+/// @file power_intervals.h
+///
+/// Run length encoded power output.  Instead of one TimeSeriesPower row per
+/// agent per time step, an agent's power is recorded to the PowerIntervals
+/// table as one (AgentId, Start, End, Value) row per run of time steps over
+/// which it is unchanged - End is inclusive.  The summed power of all agents
+/// recording intervals in a region is recorded the same way to the
+/// RegionPowerIntervals table as (RegionId, Start, End, Value) rows.  Open
+/// intervals are written out on the last time step of the simulation and when
+/// an agent is decommissioned.  Region intervals are split at restarts.
+///
+/// Agents join their region's total in Tick, so every agent of a region is
+/// known before any of them records the power of a time step in Tock.  The
+/// region's last interval is written once all of them have recorded on the
+/// last time step - an agent deployed on that step can't come after it.
+
+namespace cycamore {
+
+/// Counts agent a in its region's total from the current time step on if it
+/// is not counted yet.  Must be called from Tick on every time step.
+void JoinRegionPower(cyclus::Agent* a);
+
+/// Records power p of agent a for the current time step.  The open interval
+/// of a - which must be stored with its state - is the power value since time
+/// step start; start is negative if there is none yet.  Must be called once
+/// on every time step.
+void RecordPowerInterval(cyclus::Agent* a, double p, int* start,
+                         double* value);
+
+/// Writes out the open interval of agent a up to the current time step and
+/// removes a from its region's total.  For use on decommissioning.
+void ClosePowerInterval(cyclus::Agent* a, int* start, double* value);
+
+/// Running power totals of the agents recording intervals in each region.
+class RegionPower {
+ public:
+  /// Returns the totals of the simulation ctx belongs to - those of any
+  /// earlier simulation in the process are dropped.
+  static RegionPower* Instance(cyclus::Context* ctx);
+
+  /// Counts agent a in its region's total as of time step t with no power
+  /// if it is not counted yet.
+  void Join(cyclus::Agent* a, int t);
+
+  /// Changes the power of agent a to p as of time step t - joining its
+  /// region's total if it is not counted yet.
+  void Update(cyclus::Agent* a, int t, double p);
+
+  /// Marks agent a done for the last time step of the simulation.  The
+  /// region's interval is written out once all of its agents are done.
+  void Finish(cyclus::Agent* a);
+
+  /// Removes agent a from its region after time step t.
+  void Remove(cyclus::Agent* a, int t);
+
+ private:
+  struct Total {
+    Total() : start(-1), value(0), now(-1), next(0), n_done(0) {}
+    /// the open interval
+    int start;
+    double value;
+    /// the time step being summed and its sum so far
+    int now;
+    double next;
+    /// the power each agent counted adds to next, by agent id
+    std::map<int, double> members;
+    int n_done;
+  };
+
+  RegionPower();
+
+  /// Returns the region agent a belongs to or NULL if it has none.
+  static cyclus::Agent* Region(cyclus::Agent* a);
+
+  /// Moves the total of region r to time step t - closing its interval if
+  /// the sum of the previous time step changed it.
+  void Advance(cyclus::Agent* r, Total* tot, int t);
+
+  /// Writes out the interval [start, end] of region r.
+  void Write(cyclus::Agent* r, int start, int end, double value);
+
+  /// by region id
+  std::map<int, Total> totals_;
+  boost::uuids::uuid sim_;
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_POWER_INTERVALS_H_
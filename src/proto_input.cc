@@ -0,0 +1,110 @@
+#include "proto_input.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <libxml++/libxml++.h>
+
+namespace cycamore {
+
+namespace {
+
+std::string Escape(const std::string& s) {
+  std::string out;
+  for (int i = 0; i < s.size(); ++i) {
+    if (s[i] == '&') {
+      out += "&amp;";
+    } else if (s[i] == '<') {
+      out += "&lt;";
+    } else if (s[i] == '>') {
+      out += "&gt;";
+    } else {
+      out += s[i];
+    }
+  }
+  return out;
+}
+
+/// Writes the children of node back out as xml.
+void ToXml(const xmlpp::Node* node, std::ostream& os) {
+  xmlpp::Node::NodeList kids = node->get_children();
+  xmlpp::Node::NodeList::iterator it;
+  for (it = kids.begin(); it != kids.end(); ++it) {
+    const xmlpp::Element* e = dynamic_cast<const xmlpp::Element*>(*it);
+    const xmlpp::TextNode* t = dynamic_cast<const xmlpp::TextNode*>(*it);
+    if (e != NULL) {
+      os << "<" << e->get_name() << ">";
+      ToXml(e, os);
+      os << "</" << e->get_name() << ">";
+    } else if (t != NULL && !t->is_white_space()) {
+      os << Escape(t->get_content());
+    }
+  }
+}
+
+/// Returns the text of the first element matching xpath under node.
+std::string Text(const xmlpp::Node* node, const std::string& xpath) {
+  xmlpp::NodeSet ns = node->find(xpath);
+  const xmlpp::Element* e =
+      ns.empty() ? NULL : dynamic_cast<const xmlpp::Element*>(ns[0]);
+  if (e == NULL || e->get_child_text() == NULL) {
+    throw cyclus::ValueError("missing '" + xpath + "' in input file");
+  }
+  return e->get_child_text()->get_content();
+}
+
+}  // namespace
+
+std::string ReadPrototype(const std::string& fname, const std::string& proto,
+                          RecipeMap* recipes, std::string* spec) {
+  std::ifstream f(fname.c_str());
+  if (!f.is_open()) {
+    throw cyclus::IOError("could not open input file " + fname);
+  }
+  std::stringstream ss;
+  ss << f.rdbuf();
+  cyclus::XMLParser parser;
+  parser.Init(ss);
+  const xmlpp::Node* root = parser.Document()->get_root_node();
+
+  xmlpp::NodeSet cfg =
+      root->find("/simulation/facility[name='" + proto + "']/config/*");
+  if (cfg.empty()) {
+    throw cyclus::ValueError("no facility prototype named " + proto + " in " +
+                             fname);
+  }
+  std::stringstream config;
+  ToXml(cfg[0], config);
+
+  if (spec != NULL) {
+    std::string arche = cfg[0]->get_name();
+    xmlpp::NodeSet specs = root->find("/simulation/archetypes/spec[alias='" +
+                                      arche + "' or (not(alias) and name='" +
+                                      arche + "')]");
+    if (specs.empty()) {
+      throw cyclus::ValueError("no archetype spec for " + arche + " in " +
+                               fname);
+    }
+    *spec = ":" + Text(specs[0], "lib") + ":" + Text(specs[0], "name");
+  }
+
+  xmlpp::NodeSet recs = root->find("/simulation/recipe");
+  for (int i = 0; i < recs.size(); ++i) {
+    cyclus::CompMap m;
+    xmlpp::NodeSet nucs = recs[i]->find("nuclide");
+    for (int j = 0; j < nucs.size(); ++j) {
+      int nuc = pyne::nucname::id(Text(nucs[j], "id"));
+      m[nuc] = std::atof(Text(nucs[j], "comp").c_str());
+    }
+    std::string name = Text(recs[i], "name");
+    if (Text(recs[i], "basis") == "atom") {
+      (*recipes)[name] = cyclus::Composition::CreateFromAtom(m);
+    } else {
+      (*recipes)[name] = cyclus::Composition::CreateFromMass(m);
+    }
+  }
+  return config.str();
+}
+
+}  // namespace cycamore
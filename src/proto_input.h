@@ -0,0 +1,30 @@
+#ifndef CYCAMORE_SRC_PROTO_INPUT_H_
+#define CYCAMORE_SRC_PROTO_INPUT_H_
+
+#include <map>
+#include <string>
+
+#include "cyclus.h"
+
+/// @file proto_input.h
+///
+/// Reads a single facility prototype out of an (xml) input file so that
+/// agents of it can be built outside of a full simulation - used by the
+/// cycamore_dre_replay and cycamore_build_bench tools.
+
+namespace cycamore {
+
+typedef std::map<std::string, cyclus::Composition::Ptr> RecipeMap;
+
+/// Returns the archetype configuration of facility prototype proto in input
+/// file fname and adds the recipes defined in the file to recipes.  If spec
+/// is not NULL, it is set to the agent spec (e.g. ":cycamore:Reactor") of the
+/// prototype's archetype.
+/// @throws cyclus::IOError if the file cannot be read
+/// @throws cyclus::ValueError if the prototype or its archetype is not found
+std::string ReadPrototype(const std::string& fname, const std::string& proto,
+                          RecipeMap* recipes, std::string* spec = NULL);
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_PROTO_INPUT_H_
@@ -1,5 +1,17 @@
 #include "reactor.h"
 
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <boost/uuid/nil_generator.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "comp_interner.h"
+#include "decay_cache.h"
+#include "dre_capture.h"
+#include "instrument.h"
+#include "power_intervals.h"
+
 using cyclus::Material;
 using cyclus::Composition;
 using cyclus::toolkit::ResBuf;
@@ -17,12 +29,22 @@ Reactor::Reactor(cyclus::Context* ctx)
       n_assem_core(0),
       n_assem_spent(0),
       n_assem_fresh(0),
+      order_window(0),
       cycle_time(0),
       refuel_time(0),
       cycle_step(0),
       power_cap(0),
       power_name("power"),
-      discharged(false) {
+      power_intervals(false),
+      decay_spent(false),
+      availability(1),
+      availability_seed(0),
+      power_start(-1),
+      power_value(0),
+      discharged(false),
+      shared_schedules(false),
+      n_cycles(0),
+      wake_(0) {
   cyclus::Warn<cyclus::EXPERIMENTAL_WARNING>(
       "the Reactor archetype "
       "is experimental");
@@ -36,69 +58,192 @@ Reactor::Reactor(cyclus::Context* ctx)
 
 #pragma cyclus def infiletodb cycamore::Reactor
 
-#pragma cyclus def snapshot cycamore::Reactor
+void Reactor::Snapshot(cyclus::DbInit di) {
+  EncodeResIndexes();
+
+  // Deployed reactors never change the pref/recipe change schedules they
+  // were cloned with, so only prototypes store them.
+  shared_schedules = enter_time() >= 0;
+  const ReactorFuel& f = fuel();
+  fuel_incommods = f.incommods;
+  fuel_inrecipes = f.inrecipes;
+  fuel_outrecipes = f.outrecipes;
+  fuel_outcommods = f.outcommods;
+  fuel_prefs = f.prefs;
+  if (!shared_schedules) {
+    pref_change_times = f.pref_change_times;
+    pref_change_commods = f.pref_change_commods;
+    pref_change_values = f.pref_change_values;
+    recipe_change_times = f.recipe_change_times;
+    recipe_change_commods = f.recipe_change_commods;
+    recipe_change_in = f.recipe_change_in;
+    recipe_change_out = f.recipe_change_out;
+    burnup_commods = f.burnup_commods;
+    burnup_cycles = f.burnup_cycles;
+    burnup_recipes = f.burnup_recipes;
+  }
+
+  #pragma cyclus impl snapshot cycamore::Reactor
+
+  fuel_incommods.clear();
+  fuel_inrecipes.clear();
+  fuel_outrecipes.clear();
+  fuel_outcommods.clear();
+  fuel_prefs.clear();
+  pref_change_times.clear();
+  pref_change_commods.clear();
+  pref_change_values.clear();
+  recipe_change_times.clear();
+  recipe_change_commods.clear();
+  recipe_change_in.clear();
+  recipe_change_out.clear();
+  burnup_commods.clear();
+  burnup_cycles.clear();
+  burnup_recipes.clear();
+  res_index_runs.clear();
+}
 
 #pragma cyclus def snapshotinv cycamore::Reactor
 
-#pragma cyclus def initinv cycamore::Reactor
+void Reactor::InitInv(cyclus::Inventories& inv) {
+  SizeFresh();
+  #pragma cyclus impl initinv cycamore::Reactor
+
+  DecodeResIndexes();
+}
 
 void Reactor::InitFrom(Reactor* m) {
+  // leaves the fuel state variables of m empty so that the copy below is
+  // cheap - the configuration itself is shared.
+  m->ShareFuel();
   #pragma cyclus impl initfromcopy cycamore::Reactor
-  cyclus::toolkit::CommodityProducer::Copy(m);
+  fuel_ = m->fuel_;
+  // power is the only commodity a reactor produces and its capacity is a
+  // state variable just copied - add it directly instead of copying every
+  // commodity of m one lookup at a time.
+  namespace tk = cyclus::toolkit;
+  tk::CommodityProducer::Add(tk::Commodity(power_name),
+                             tk::CommodInfo(power_cap, power_cap));
 }
 
+namespace {
+
+typedef std::map<std::string, boost::weak_ptr<ReactorFuel> > FuelMap;
+
+// Returns the fuel configurations of the prototypes restored in the
+// simulation of ctx by prototype name.  Prototypes are restored before the
+// deployed reactors that share their configuration.
+FuelMap* PrototypeFuels(cyclus::Context* ctx) {
+  static FuelMap fuels;
+  static boost::uuids::uuid sim = boost::uuids::nil_uuid();
+  if (ctx->sim_id() != sim) {
+    fuels.clear();
+    sim = ctx->sim_id();
+  }
+  return &fuels;
+}
+
+}  // namespace
+
 void Reactor::InitFrom(cyclus::QueryableBackend* b) {
   #pragma cyclus impl initfromdb cycamore::Reactor
 
+  FuelMap* protos = PrototypeFuels(context());
+  if (enter_time() < 0) {
+    ShareFuel();
+    (*protos)[prototype()] = fuel_;
+  } else if (shared_schedules) {
+    // restored from the snapshot of a deployed reactor - the prototype has
+    // already been restored and holds the change schedules.  Share its
+    // configuration outright unless prefs or recipes have changed since.
+    boost::shared_ptr<ReactorFuel> proto_fuel;
+    FuelMap::iterator it = protos->find(prototype());
+    if (it != protos->end()) {
+      proto_fuel = it->second.lock();
+    }
+    if (!proto_fuel) {
+      throw KeyError("prototype '" + prototype() +
+                     "' was not restored before its reactors");
+    }
+    const ReactorFuel& pf = *proto_fuel;
+    if (fuel_incommods == pf.incommods && fuel_inrecipes == pf.inrecipes &&
+        fuel_outrecipes == pf.outrecipes &&
+        fuel_outcommods == pf.outcommods && fuel_prefs == pf.prefs) {
+      fuel_ = proto_fuel;
+      fuel_incommods.clear();
+      fuel_inrecipes.clear();
+      fuel_outrecipes.clear();
+      fuel_outcommods.clear();
+      fuel_prefs.clear();
+    } else {
+      pref_change_times = pf.pref_change_times;
+      pref_change_commods = pf.pref_change_commods;
+      pref_change_values = pf.pref_change_values;
+      recipe_change_times = pf.recipe_change_times;
+      recipe_change_commods = pf.recipe_change_commods;
+      recipe_change_in = pf.recipe_change_in;
+      recipe_change_out = pf.recipe_change_out;
+      burnup_commods = pf.burnup_commods;
+      burnup_cycles = pf.burnup_cycles;
+      burnup_recipes = pf.burnup_recipes;
+      ShareFuel();
+    }
+    shared_schedules = false;
+  }
+
   namespace tk = cyclus::toolkit;
   tk::CommodityProducer::Add(tk::Commodity(power_name),
                              tk::CommodInfo(power_cap, power_cap));
+
+  if (enter_time() >= 0) {
+    // restarted - the outages are the ones drawn at deployment
+    BuildAvailability();
+  }
 }
 
 void Reactor::EnterNotify() {
   cyclus::Facility::EnterNotify();
-  
-  // If the user ommitted fuel_prefs, we set it to zeros for each fuel
-  // type.  Without this segfaults could occur - yuck.
-  if (fuel_prefs.size() == 0) {
-    for (int i = 0; i < fuel_outcommods.size(); i++) {
-      fuel_prefs.push_back(0);
-    }
-  }
+  SizeFresh();
 
-  // input consistency checking:
-  int n = recipe_change_times.size();
+  // input consistency checking - the fuel configuration is shared by all
+  // reactors of a prototype, so it only needs to be checked when the first of
+  // them is deployed.
   std::stringstream ss;
-  if (recipe_change_commods.size() != n) {
-    ss << "prototype '" << prototype() << "' has "
-       << recipe_change_commods.size()
-       << " recipe_change_commods vals, expected " << n << "\n";
+  const ReactorFuel& f = fuel();
+  if (!f.checked) {
+    ss << f.Check(prototype());
+  }
+  if (outage_lengths.size() != outage_starts.size()) {
+    ss << "prototype '" << prototype() << "' has " << outage_lengths.size()
+       << " outage_lengths vals, expected " << outage_starts.size() << "\n";
+  }
+  for (int i = 0; i < outage_lengths.size(); i++) {
+    if (outage_lengths[i] < 0) {
+      ss << "prototype '" << prototype() << "' has outage_lengths val "
+         << outage_lengths[i] << ", expected 0 or more\n";
+    }
   }
-  if (recipe_change_in.size() != n) {
-    ss << "prototype '" << prototype() << "' has " << recipe_change_in.size()
-       << " recipe_change_in vals, expected " << n << "\n";
-  }
-  if (recipe_change_out.size() != n) {
-    ss << "prototype '" << prototype() << "' has " << recipe_change_out.size()
-       << " recipe_change_out vals, expected " << n << "\n";
-  }
-
-  n = pref_change_times.size();
-  if (pref_change_commods.size() != n) {
-    ss << "prototype '" << prototype() << "' has " << pref_change_commods.size()
-       << " pref_change_commods vals, expected " << n << "\n";
-  }
-  if (pref_change_values.size() != n) {
-    ss << "prototype '" << prototype() << "' has " << pref_change_values.size()
-       << " pref_change_values vals, expected " << n << "\n";
+  if (availability < 0 || availability > 1) {
+    ss << "prototype '" << prototype() << "' has availability "
+       << availability << ", expected 0 to 1\n";
   }
 
   if (ss.str().size() > 0) {
     throw cyclus::ValueError(ss.str());
   }
+  fuel_->checked = true;
+  BuildAvailability();
 }
 
 void Reactor::Tick() {
+  CYCAMORE_TIME("Tick");
+  if (power_intervals) {
+    JoinRegionPower(this);
+  }
+  if (context()->time() < wake_) {
+    return;
+  }
+
   // The following code must go in the Tick so they fire on the time step
   // following the cycle_step update - allowing for the all reactor events to
   // occur and be recorded on the "beginning" of a time step.  Another reason
@@ -117,61 +262,33 @@ void Reactor::Tick() {
   }
 
   int t = context()->time();
-
-  // update preferences
-  for (int i = 0; i < pref_change_times.size(); i++) {
-    int change_t = pref_change_times[i];
-    if (t != change_t) {
-      continue;
-    }
-
-    std::string incommod = pref_change_commods[i];
-    for (int j = 0; j < fuel_incommods.size(); j++) {
-      if (fuel_incommods[j] == incommod) {
-        fuel_prefs[j] = pref_change_values[i];
-        break;
-      }
-    }
-  }
-
-  // update recipes
-  for (int i = 0; i < recipe_change_times.size(); i++) {
-    int change_t = recipe_change_times[i];
-    if (t != change_t) {
-      continue;
-    }
-
-    std::string incommod = recipe_change_commods[i];
-    for (int j = 0; j < fuel_incommods.size(); j++) {
-      if (fuel_incommods[j] == incommod) {
-        fuel_inrecipes[j] = recipe_change_in[i];
-        fuel_outrecipes[j] = recipe_change_out[i];
-        break;
-      }
-    }
+  if (fuel().ChangesAt(t)) {
+    mutable_fuel().ApplyChanges(t);
   }
 }
 
 std::set<cyclus::RequestPortfolio<Material>::Ptr> Reactor::GetMatlRequests() {
+  CYCAMORE_TIME("GetMatlRequests");
   using cyclus::RequestPortfolio;
 
   std::set<RequestPortfolio<Material>::Ptr> ports;
   Material::Ptr m;
 
-  int n_assem_order =
-      n_assem_core - core.count() + n_assem_fresh - fresh.count();
+  int n_assem_order = NOrder();
   if (n_assem_order == 0) {
     return ports;
   }
 
+  targets_.Reset(context()->time());
   for (int i = 0; i < n_assem_order; i++) {
     RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
     std::vector<Request<Material>*> mreqs;
-    for (int j = 0; j < fuel_incommods.size(); j++) {
-      std::string commod = fuel_incommods[j];
-      double pref = fuel_prefs[j];
-      Composition::Ptr recipe = context()->GetRecipe(fuel_inrecipes[j]);
-      m = Material::CreateUntracked(assem_size, recipe);
+    const ReactorFuel& f = fuel();
+    for (int j = 0; j < f.incommods.size(); j++) {
+      std::string commod = f.incommods[j];
+      double pref = f.prefs[j];
+      Composition::Ptr recipe = context()->GetRecipe(f.inrecipes[j]);
+      m = targets_.Get(assem_size, recipe);
       Request<Material>* r = port->AddRequest(m, this, commod, pref, true);
       mreqs.push_back(r);
     }
@@ -179,6 +296,7 @@ std::set<cyclus::RequestPortfolio<Material>::Ptr> Reactor::GetMatlRequests() {
     ports.insert(port);
   }
 
+  CYCAMORE_COUNT_REQUESTS(ports);
   return ports;
 }
 
@@ -186,62 +304,90 @@ void Reactor::GetMatlTrades(
     const std::vector<cyclus::Trade<Material> >& trades,
     std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
         responses) {
+  CYCAMORE_TIME("GetMatlTrades");
+  dre::CaptureTrades(this, trades);
   using cyclus::Trade;
 
   std::map<std::string, MatVec> mats = PopSpent();
   std::vector<cyclus::Trade<cyclus::Material> >::const_iterator it;
   for (int i = 0; i < trades.size(); i++) {
     std::string commod = trades[i].request->commodity();
-    Material::Ptr m = mats[commod].back();
-    mats[commod].pop_back();
+    MatVec& lots = mats[commod];
+    Material::Ptr m;
+    if (Assemblies(lots.back()->quantity()) > 1) {
+      // assemblies are split off their lot only when traded
+      m = lots.back()->ExtractQty(assem_size);
+    } else {
+      m = lots.back();
+      lots.pop_back();
+      res_indexes.erase(m->obj_id());
+    }
+    if (decay_spent) {
+      m->Transmute(Decayed(m));
+    }
     responses.push_back(std::make_pair(trades[i], m));
-    res_indexes.erase(m->obj_id());
   }
   PushSpent(mats);  // return leftovers back to spent buffer
 }
 
 void Reactor::AcceptMatlTrades(const std::vector<
     std::pair<cyclus::Trade<Material>, Material::Ptr> >& responses) {
+  CYCAMORE_TIME("AcceptMatlTrades");
+  dre::CaptureAccepts(this, responses);
   std::vector<std::pair<cyclus::Trade<cyclus::Material>,
                         cyclus::Material::Ptr> >::const_iterator trade;
 
   std::stringstream ss;
-  int nload = std::min((int)responses.size(), n_assem_core - core.count());
+  int nload =
+      std::min((int)responses.size(), n_assem_core - Assemblies(core));
   if (nload > 0) {
     ss << nload << " assemblies";
     Record("LOAD", ss.str());
   }
 
+  // the core is filled first and the rest goes to the fresh fuel buffer -
+  // each as lots of identical assemblies
+  MatVec tocore;
+  MatVec tofresh;
   for (trade = responses.begin(); trade != responses.end(); ++trade) {
     std::string commod = trade->first.request->commodity();
     Material::Ptr m = trade->second;
     index_res(m, commod);
-
-    if (core.count() < n_assem_core) {
-      core.Push(m);
+    if (tocore.size() < nload) {
+      tocore.push_back(m);
     } else {
-      fresh.Push(m);
+      tofresh.push_back(m);
     }
   }
+  tocore = Merge(tocore);
+  core.Push(tocore);
+  core_loaded.insert(core_loaded.end(), tocore.size(), n_cycles);
+  fresh.Push(Merge(tofresh));
 }
 
 std::set<cyclus::BidPortfolio<Material>::Ptr> Reactor::GetMatlBids(
     cyclus::CommodMap<Material>::type& commod_requests) {
+  CYCAMORE_TIME("GetMatlBids");
+  dre::CaptureBids(this, commod_requests);
   using cyclus::BidPortfolio;
 
   std::set<BidPortfolio<Material>::Ptr> ports;
 
   bool gotmats = false;
   std::map<std::string, MatVec> all_mats;
-  for (int i = 0; i < fuel_outcommods.size(); i++) {
-    std::string commod = fuel_outcommods[i];
-    std::vector<Request<Material>*>& reqs = commod_requests[commod];
-    if (reqs.size() == 0) {
+  const std::vector<std::string>& outcommods = fuel().outcommods;
+  for (int i = 0; i < outcommods.size(); i++) {
+    std::string commod = outcommods[i];
+    // the request map is shared by all bidders - look up without inserting
+    cyclus::CommodMap<Material>::type::const_iterator found =
+        commod_requests.find(commod);
+    if (found == commod_requests.end() || found->second.size() == 0) {
       continue;
     } else if (!gotmats) {
       all_mats = PeekSpent();
     }
 
+    const std::vector<Request<Material>*>& reqs = found->second;
     MatVec mats = all_mats[commod];
     if (mats.size() == 0) {
       continue;
@@ -249,11 +395,23 @@ std::set<cyclus::BidPortfolio<Material>::Ptr> Reactor::GetMatlBids(
 
     BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
 
+    // one offer per assembly in the lots - spent fuel is offered as it is
+    // now without decaying the real thing
+    offers_.Reset(context()->time());
+    MatVec offers;
+    double tot_qty = 0;
+    for (int k = 0; k < mats.size(); k++) {
+      Composition::Ptr c = decay_spent ? Decayed(mats[k]) : mats[k]->comp();
+      offers.insert(offers.end(), Assemblies(mats[k]->quantity()),
+                    offers_.Get(assem_size, c));
+      tot_qty += mats[k]->quantity();
+    }
+
     for (int j = 0; j < reqs.size(); j++) {
       Request<Material>* req = reqs[j];
       double tot_bid = 0;
-      for (int k = 0; k < mats.size(); k++) {
-        Material::Ptr m = mats[k];
+      for (int k = 0; k < offers.size(); k++) {
+        Material::Ptr m = offers[k];
         tot_bid += m->quantity();
         port->AddBid(req, m, this, true);
         if (tot_bid >= req->target()->quantity()) {
@@ -262,58 +420,157 @@ std::set<cyclus::BidPortfolio<Material>::Ptr> Reactor::GetMatlBids(
       }
     }
 
-    double tot_qty = 0;
-    for (int j = 0; j < mats.size(); j++) {
-      tot_qty += mats[j]->quantity();
-    }
     cyclus::CapacityConstraint<Material> cc(tot_qty);
     port->AddConstraint(cc);
     ports.insert(port);
   }
 
+  CYCAMORE_COUNT_BIDS(ports);
   return ports;
 }
 
 void Reactor::Tock() {
-  if (cycle_step >= cycle_time + refuel_time && core.count() == n_assem_core) {
+  CYCAMORE_TIME("Tock");
+  if (context()->time() < wake_ && Available(context()->time())) {
+    // mid-cycle with a full core - the only thing to do
+    RecordPower(power_cap);
+    cycle_step++;
+    return;
+  }
+
+  bool full = Assemblies(core) == n_assem_core;
+  bool up = Available(context()->time());
+  if (cycle_step >= cycle_time + refuel_time && full) {
     discharged = false;
     cycle_step = 0;
   }
 
-  if (cycle_step == 0 && core.count() == n_assem_core) {
+  if (cycle_step == 0 && full && up) {
     Record("CYCLE_START", "");
   }
 
-  if (cycle_step >= 0 && cycle_step < cycle_time &&
-      core.count() == n_assem_core) {
-    cyclus::toolkit::RecordTimeSeries<cyclus::toolkit::POWER>(this, power_cap);
+  if (cycle_step >= 0 && cycle_step < cycle_time && full && up) {
+    RecordPower(power_cap);
   } else {
-    cyclus::toolkit::RecordTimeSeries<cyclus::toolkit::POWER>(this, 0);
+    RecordPower(0);
   }
 
   // "if" prevents starting cycle after initial deployment until core is full
-  // even though cycle_step is its initial zero.
-  if (cycle_step > 0 || core.count() == n_assem_core) {
+  // even though cycle_step is its initial zero.  Outages hold the cycle
+  // (or its start) but not refueling.
+  if ((cycle_step > 0 || full) && (up || cycle_step >= cycle_time)) {
     cycle_step++;
   }
+  wake_ = NextEventTime();
+}
+
+int Reactor::NextEventTime() {
+  int t = context()->time();
+  if (cycle_step <= 0 || cycle_step >= cycle_time ||
+      Assemblies(core) < n_assem_core) {
+    return t + 1;
+  }
+
+  // Tick sees cycle_step + k - 1 on time step t + k and ends the cycle when
+  // that reaches cycle_time.  The core can't change before then: it is only
+  // unloaded at cycle end and a full core receives no fuel.
+  int next = t + 1 + cycle_time - cycle_step;
+  const ReactorFuel& f = fuel();
+  for (int i = 0; i < f.pref_change_times.size(); i++) {
+    if (f.pref_change_times[i] > t) {
+      next = std::min(next, f.pref_change_times[i]);
+    }
+  }
+  for (int i = 0; i < f.recipe_change_times.size(); i++) {
+    if (f.recipe_change_times[i] > t) {
+      next = std::min(next, f.recipe_change_times[i]);
+    }
+  }
+  return next;
 }
 
 void Reactor::Transmute() {
   // safe to assume full core.
-  MatVec old = core.PopN(n_assem_batch);
+  int whole = 0;
+  MatVec old = PopAssemblies(&core, n_assem_batch, &whole);
   MatVec tail = core.PopN(core.count());
   core.Push(old);
   core.Push(tail);
+  if (old.size() > whole && whole < core_loaded.size()) {
+    // a lot split at the batch boundary is now two lots loaded together
+    core_loaded.insert(core_loaded.begin() + whole, core_loaded[whole]);
+  }
 
   std::stringstream ss;
-  ss << old.size() << " assemblies";
+  ss << n_assem_batch << " assemblies";
   Record("TRANSMUTE", ss.str());
 
+  n_cycles++;
   for (int i = 0; i < old.size(); i++) {
-    old[i]->Transmute(context()->GetRecipe(fuel_outrecipe(old[i])));
+    // assemblies of unknown age (e.g. from before the core was tracked)
+    // count as in the core for a single cycle
+    int cycles = i < core_loaded.size() ? n_cycles - core_loaded[i] : 1;
+    Composition::Ptr c = BurnupComp(fuel_index(old[i]), cycles);
+    if (!c) {
+      c = context()->GetRecipe(fuel_outrecipe(old[i]));
+    }
+    old[i]->Transmute(c);
   }
 }
 
+Composition::Ptr Reactor::BurnupComp(int i, int cycles) {
+  const ReactorFuel& f = fuel();
+  if (f.burnup_commods.empty() || i >= f.incommods.size()) {
+    return Composition::Ptr();
+  }
+  std::pair<int, int> key(i, cycles);
+  std::map<std::pair<int, int>, Composition::Ptr>::iterator it =
+      f.burnup_comps.find(key);
+  if (it != f.burnup_comps.end()) {
+    return it->second;
+  }
+
+  // the nearest points at or below and at or above cycles
+  int lo = -1;
+  int hi = -1;
+  for (int j = 0; j < f.burnup_commods.size(); j++) {
+    if (f.burnup_commods[j] != f.incommods[i]) {
+      continue;
+    }
+    double x = f.burnup_cycles[j];
+    if (x <= cycles && (lo < 0 || x > f.burnup_cycles[lo])) {
+      lo = j;
+    }
+    if (x >= cycles && (hi < 0 || x < f.burnup_cycles[hi])) {
+      hi = j;
+    }
+  }
+
+  Composition::Ptr c;
+  if (lo < 0 && hi < 0) {
+    // no table for this fuel
+  } else if (lo < 0 || hi < 0 || lo == hi ||
+             f.burnup_cycles[lo] == f.burnup_cycles[hi]) {
+    c = context()->GetRecipe(f.burnup_recipes[lo < 0 ? hi : lo]);
+  } else {
+    double w = (cycles - f.burnup_cycles[lo]) /
+               (f.burnup_cycles[hi] - f.burnup_cycles[lo]);
+    cyclus::CompMap v = context()->GetRecipe(f.burnup_recipes[lo])->mass();
+    cyclus::CompMap hv = context()->GetRecipe(f.burnup_recipes[hi])->mass();
+    cyclus::compmath::Normalize(&v, 1 - w);
+    cyclus::compmath::Normalize(&hv, w);
+    c = CompInterner::Instance(context())->Mass(cyclus::compmath::Add(v, hv));
+  }
+  f.burnup_comps[key] = c;
+  return c;
+}
+
+Composition::Ptr Reactor::Decayed(Material::Ptr m) {
+  // transmuting resets the decay clock, so this is the time since discharge
+  int dt = context()->time() - m->prev_decay_time();
+  return DecayCache::Instance(context())->Decay(m->comp(), dt);
+}
+
 std::map<std::string, MatVec> Reactor::PeekSpent() {
   std::map<std::string, MatVec> mapped;
   MatVec mats = spent.PopN(spent.count());
@@ -326,23 +583,27 @@ std::map<std::string, MatVec> Reactor::PeekSpent() {
 }
 
 bool Reactor::Discharge() {
-  if (n_assem_spent - spent.count() < n_assem_batch) {
+  if (n_assem_spent - Assemblies(spent) < n_assem_batch) {
     Record("DISCHARGE", "failed");
     return false;  // not enough room in spent buffer
   }
 
-  int npop = std::min(n_assem_batch, core.count());
+  int npop = std::min(n_assem_batch, Assemblies(core));
 
   std::stringstream ss;
   ss << npop << " assemblies";
   Record("DISCHARGE", ss.str());
 
-  spent.Push(core.PopN(npop));
+  // the rest of a split lot keeps its load cycle
+  int whole = 0;
+  spent.Push(Merge(PopAssemblies(&core, npop, &whole)));
+  core_loaded.erase(core_loaded.begin(),
+                    core_loaded.begin() + std::min<int>(whole, core_loaded.size()));
   return true;
 }
 
 void Reactor::Load() {
-  int n = std::min(n_assem_core - core.count(), fresh.count());
+  int n = std::min(n_assem_core - Assemblies(core), Assemblies(fresh));
   if (n == 0) {
     return;
   }
@@ -350,58 +611,144 @@ void Reactor::Load() {
   std::stringstream ss;
   ss << n << " assemblies";
   Record("LOAD", ss.str());
-  core.Push(fresh.PopN(n));
+  MatVec lots = PopAssemblies(&fresh, n, NULL);
+  core.Push(lots);
+  core_loaded.insert(core_loaded.end(), lots.size(), n_cycles);
+}
+
+int Reactor::NOrder() {
+  int n = n_assem_core - Assemblies(core) + n_assem_fresh - Assemblies(fresh);
+  int left = cycle_time - cycle_step;
+  if (order_window > 0 && Assemblies(core) == n_assem_core && left >= 1 &&
+      left <= order_window) {
+    // the share of the next batch due by now - all of it on the last step
+    int due = order_window - left + 1;
+    n += (n_assem_batch * due + order_window - 1) / order_window;
+  }
+  return std::max(0, n);
+}
+
+void Reactor::BuildAvailability() {
+  avail_.clear();
+  if (availability >= 1 && outage_starts.empty()) {
+    return;
+  }
+
+  int n = context()->sim_dur();
+  avail_.assign(n, true);
+  if (availability < 1) {
+    // different draws for each reactor, but the same ones on every run
+    boost::random::mt19937 gen(availability_seed * 1000003u + id());
+    boost::random::uniform_01<double> u;
+    for (int t = std::max(0, enter_time()); t < n; t++) {
+      avail_[t] = u(gen) < availability;
+    }
+  }
+  for (int i = 0; i < outage_starts.size() && i < outage_lengths.size(); i++) {
+    int end = std::min(n, outage_starts[i] + outage_lengths[i]);
+    for (int t = std::max(0, outage_starts[i]); t < end; t++) {
+      avail_[t] = false;
+    }
+  }
+}
+
+void Reactor::SizeFresh() {
+  if (order_window > 0) {
+    fresh.capacity((n_assem_fresh + n_assem_batch) * assem_size);
+  }
+}
+
+MatVec Reactor::PopAssemblies(ResBuf<Material>* buf, int n, int* whole) {
+  MatVec lots = buf->PopN(buf->count());
+  MatVec popped;
+  int i = 0;
+  for (; i < lots.size() && n > 0; i++) {
+    int k = Assemblies(lots[i]->quantity());
+    if (k > n) {
+      break;
+    }
+    popped.push_back(lots[i]);
+    n -= k;
+  }
+  if (whole != NULL) {
+    *whole = popped.size();
+  }
+  if (n > 0 && i < lots.size()) {
+    Material::Ptr part = lots[i]->ExtractQty(n * assem_size);
+    res_indexes[part->obj_id()] = fuel_index(lots[i]);
+    popped.push_back(part);
+  }
+  buf->Push(MatVec(lots.begin() + i, lots.end()));
+  return popped;
+}
+
+MatVec Reactor::Merge(const MatVec& lots) {
+  MatVec merged;
+  for (int i = 0; i < lots.size(); i++) {
+    Material::Ptr m = lots[i];
+    if (!merged.empty() && merged.back()->comp() == m->comp() &&
+        fuel_index(merged.back()) == fuel_index(m)) {
+      merged.back()->Absorb(m);
+      res_indexes.erase(m->obj_id());
+    } else {
+      merged.push_back(m);
+    }
+  }
+  return merged;
+}
+
+int Reactor::fuel_index(Material::Ptr m) const {
+  std::map<int, int>::const_iterator it = res_indexes.find(m->obj_id());
+  return it == res_indexes.end() ? 0 : it->second;
 }
 
 std::string Reactor::fuel_incommod(Material::Ptr m) {
-  int i = res_indexes[m->obj_id()];
-  if (i >= fuel_incommods.size()) {
+  int i = fuel_index(m);
+  if (i >= fuel().incommods.size()) {
     throw KeyError("cycamore::Reactor - no incommod for material object");
   }
-  return fuel_incommods[i];
+  return fuel().incommods[i];
 }
 
 std::string Reactor::fuel_outcommod(Material::Ptr m) {
-  int i = res_indexes[m->obj_id()];
-  if (i >= fuel_outcommods.size()) {
+  int i = fuel_index(m);
+  if (i >= fuel().outcommods.size()) {
     throw KeyError("cycamore::Reactor - no outcommod for material object");
   }
-  return fuel_outcommods[i];
+  return fuel().outcommods[i];
 }
 
 std::string Reactor::fuel_inrecipe(Material::Ptr m) {
-  int i = res_indexes[m->obj_id()];
-  if (i >= fuel_inrecipes.size()) {
+  int i = fuel_index(m);
+  if (i >= fuel().inrecipes.size()) {
     throw KeyError("cycamore::Reactor - no inrecipe for material object");
   }
-  return fuel_inrecipes[i];
+  return fuel().inrecipes[i];
 }
 
 std::string Reactor::fuel_outrecipe(Material::Ptr m) {
-  int i = res_indexes[m->obj_id()];
-  if (i >= fuel_outrecipes.size()) {
+  int i = fuel_index(m);
+  if (i >= fuel().outrecipes.size()) {
     throw KeyError("cycamore::Reactor - no outrecipe for material object");
   }
-  return fuel_outrecipes[i];
+  return fuel().outrecipes[i];
 }
 
 double Reactor::fuel_pref(Material::Ptr m) {
-  int i = res_indexes[m->obj_id()];
-  if (i >= fuel_prefs.size()) {
+  int i = fuel_index(m);
+  if (i >= fuel().prefs.size()) {
     return 0;
   }
-  return fuel_prefs[i];
+  return fuel().prefs[i];
 }
 
 void Reactor::index_res(cyclus::Resource::Ptr m, std::string incommod) {
-  for (int i = 0; i < fuel_incommods.size(); i++) {
-    if (fuel_incommods[i] == incommod) {
-      res_indexes[m->obj_id()] = i;
-      return;
-    }
+  int i = fuel().index(incommod);
+  if (i < 0) {
+    throw ValueError(
+        "cycamore::Reactor - received unsupported incommod material");
   }
-  throw ValueError(
-      "cycamore::Reactor - received unsupported incommod material");
+  res_indexes[m->obj_id()] = i;
 }
 
 std::map<std::string, MatVec> Reactor::PopSpent() {
@@ -430,6 +777,180 @@ void Reactor::PushSpent(std::map<std::string, MatVec> leftover) {
   }
 }
 
+const ReactorFuel& Reactor::fuel() {
+  if (!fuel_) {
+    ShareFuel();
+  }
+  return *fuel_;
+}
+
+ReactorFuel& Reactor::mutable_fuel() {
+  if (!fuel_) {
+    ShareFuel();
+  } else if (!fuel_.unique()) {
+    fuel_.reset(new ReactorFuel(*fuel_));
+  }
+  return *fuel_;
+}
+
+void Reactor::ShareFuel() {
+  if (fuel_) {
+    return;
+  }
+
+  fuel_.reset(new ReactorFuel());
+  fuel_->incommods.swap(fuel_incommods);
+  fuel_->inrecipes.swap(fuel_inrecipes);
+  fuel_->outrecipes.swap(fuel_outrecipes);
+  fuel_->outcommods.swap(fuel_outcommods);
+  fuel_->prefs.swap(fuel_prefs);
+  fuel_->pref_change_times.swap(pref_change_times);
+  fuel_->pref_change_commods.swap(pref_change_commods);
+  fuel_->pref_change_values.swap(pref_change_values);
+  fuel_->recipe_change_times.swap(recipe_change_times);
+  fuel_->recipe_change_commods.swap(recipe_change_commods);
+  fuel_->recipe_change_in.swap(recipe_change_in);
+  fuel_->recipe_change_out.swap(recipe_change_out);
+  fuel_->burnup_commods.swap(burnup_commods);
+  fuel_->burnup_cycles.swap(burnup_cycles);
+  fuel_->burnup_recipes.swap(burnup_recipes);
+  fuel_->DefaultPrefs();
+}
+
+void Reactor::EncodeResIndexes() {
+  std::vector<int> idx;
+  ResBuf<Material>* bufs[] = {&fresh, &core, &spent};
+  for (int b = 0; b < 3; b++) {
+    MatVec mats = bufs[b]->PopN(bufs[b]->count());
+    bufs[b]->Push(mats);
+    for (int i = 0; i < mats.size(); i++) {
+      std::map<int, int>::iterator it = res_indexes.find(mats[i]->obj_id());
+      idx.push_back(it == res_indexes.end() ? 0 : it->second);
+    }
+  }
+  res_index_runs = RunLengthEncode(idx);
+}
+
+void Reactor::DecodeResIndexes() {
+  std::vector<int> idx = RunLengthDecode(res_index_runs);
+  res_index_runs.clear();
+  res_indexes.clear();
+
+  int pos = 0;
+  ResBuf<Material>* bufs[] = {&fresh, &core, &spent};
+  for (int b = 0; b < 3; b++) {
+    MatVec mats = bufs[b]->PopN(bufs[b]->count());
+    bufs[b]->Push(mats);
+    for (int i = 0; i < mats.size() && pos < idx.size(); i++, pos++) {
+      res_indexes[mats[i]->obj_id()] = idx[pos];
+    }
+  }
+}
+
+void ReactorFuel::DefaultPrefs() {
+  // Without a pref for every fuel segfaults could occur - yuck.
+  if (prefs.empty()) {
+    prefs.assign(outcommods.size(), 0);
+  }
+}
+
+int ReactorFuel::index(const std::string& incommod) const {
+  for (int i = 0; i < incommods.size(); i++) {
+    if (incommods[i] == incommod) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+std::string ReactorFuel::Check(const std::string& proto) const {
+  int n = recipe_change_times.size();
+  std::stringstream ss;
+  if (recipe_change_commods.size() != n) {
+    ss << "prototype '" << proto << "' has " << recipe_change_commods.size()
+       << " recipe_change_commods vals, expected " << n << "\n";
+  }
+  if (recipe_change_in.size() != n) {
+    ss << "prototype '" << proto << "' has " << recipe_change_in.size()
+       << " recipe_change_in vals, expected " << n << "\n";
+  }
+  if (recipe_change_out.size() != n) {
+    ss << "prototype '" << proto << "' has " << recipe_change_out.size()
+       << " recipe_change_out vals, expected " << n << "\n";
+  }
+
+  n = pref_change_times.size();
+  if (pref_change_commods.size() != n) {
+    ss << "prototype '" << proto << "' has " << pref_change_commods.size()
+       << " pref_change_commods vals, expected " << n << "\n";
+  }
+  if (pref_change_values.size() != n) {
+    ss << "prototype '" << proto << "' has " << pref_change_values.size()
+       << " pref_change_values vals, expected " << n << "\n";
+  }
+
+  n = burnup_commods.size();
+  if (burnup_cycles.size() != n) {
+    ss << "prototype '" << proto << "' has " << burnup_cycles.size()
+       << " burnup_cycles vals, expected " << n << "\n";
+  }
+  if (burnup_recipes.size() != n) {
+    ss << "prototype '" << proto << "' has " << burnup_recipes.size()
+       << " burnup_recipes vals, expected " << n << "\n";
+  }
+  for (int i = 0; i < n; i++) {
+    if (index(burnup_commods[i]) < 0) {
+      ss << "prototype '" << proto << "' has burnup table points for '"
+         << burnup_commods[i] << "', which is not one of its fuel_incommods\n";
+    }
+  }
+  return ss.str();
+}
+
+bool ReactorFuel::ChangesAt(int t) const {
+  return std::find(pref_change_times.begin(), pref_change_times.end(), t) !=
+             pref_change_times.end() ||
+         std::find(recipe_change_times.begin(), recipe_change_times.end(),
+                   t) != recipe_change_times.end();
+}
+
+void ReactorFuel::ApplyChanges(int t) {
+  for (int i = 0; i < pref_change_times.size(); i++) {
+    int j = index(pref_change_commods[i]);
+    if (pref_change_times[i] == t && j >= 0) {
+      prefs[j] = pref_change_values[i];
+    }
+  }
+  for (int i = 0; i < recipe_change_times.size(); i++) {
+    int j = index(recipe_change_commods[i]);
+    if (recipe_change_times[i] == t && j >= 0) {
+      inrecipes[j] = recipe_change_in[i];
+      outrecipes[j] = recipe_change_out[i];
+    }
+  }
+}
+
+std::vector<int> RunLengthEncode(const std::vector<int>& vals) {
+  std::vector<int> runs;
+  for (int i = 0; i < vals.size(); i++) {
+    if (runs.empty() || runs.back() != vals[i]) {
+      runs.push_back(1);
+      runs.push_back(vals[i]);
+    } else {
+      runs[runs.size() - 2]++;
+    }
+  }
+  return runs;
+}
+
+std::vector<int> RunLengthDecode(const std::vector<int>& runs) {
+  std::vector<int> vals;
+  for (int i = 0; i + 1 < runs.size(); i += 2) {
+    vals.insert(vals.end(), runs[i], runs[i + 1]);
+  }
+  return vals;
+}
+
 void Reactor::Record(std::string name, std::string val) {
   context()
       ->NewDatum("ReactorEvents")
@@ -440,6 +961,21 @@ void Reactor::Record(std::string name, std::string val) {
       ->Record();
 }
 
+void Reactor::RecordPower(double p) {
+  if (power_intervals) {
+    RecordPowerInterval(this, p, &power_start, &power_value);
+  } else {
+    cyclus::toolkit::RecordTimeSeries<cyclus::toolkit::POWER>(this, p);
+  }
+}
+
+void Reactor::Decommission() {
+  if (power_intervals) {
+    ClosePowerInterval(this, &power_start, &power_value);
+  }
+  cyclus::Facility::Decommission();
+}
+
 extern "C" cyclus::Agent* ConstructReactor(cyclus::Context* ctx) {
   return new Reactor(ctx);
 }
@@ -1,10 +1,68 @@
 #ifndef CYCAMORE_SRC_REACTOR_H_
 #define CYCAMORE_SRC_REACTOR_H_
 
+#include <map>
+#include <utility>
+
+#include <boost/shared_ptr.hpp>
+
 #include "cyclus.h"
+#include "untracked_pool.h"
 
 namespace cycamore {
 
+/// The fuel and fuel change configuration of a Reactor or ReactorFleet.  A
+/// single instance is shared (read-only) by a prototype and every agent cloned
+/// from it; an agent gets its own copy only when a pref or recipe change
+/// fires.
+struct ReactorFuel {
+  ReactorFuel() : checked(false) {}
+
+  /// Sets a zero pref for every fuel if no prefs were given.
+  void DefaultPrefs();
+
+  /// Returns the index of the fuel received on incommod, or -1 if there is
+  /// none.
+  int index(const std::string& incommod) const;
+
+  /// Returns a line for every inconsistency in the change schedules and the
+  /// burnup table of prototype proto - an empty string if there are none.
+  std::string Check(const std::string& proto) const;
+
+  /// Returns true if a pref or recipe change fires on time step t.
+  bool ChangesAt(int t) const;
+
+  /// Applies the pref and recipe changes firing on time step t.
+  void ApplyChanges(int t);
+
+  std::vector<std::string> incommods;
+  std::vector<std::string> inrecipes;
+  std::vector<std::string> outrecipes;
+  std::vector<std::string> outcommods;
+  std::vector<double> prefs;
+
+  std::vector<int> pref_change_times;
+  std::vector<std::string> pref_change_commods;
+  std::vector<double> pref_change_values;
+
+  std::vector<int> recipe_change_times;
+  std::vector<std::string> recipe_change_commods;
+  std::vector<std::string> recipe_change_in;
+  std::vector<std::string> recipe_change_out;
+
+  std::vector<std::string> burnup_commods;
+  std::vector<double> burnup_cycles;
+  std::vector<std::string> burnup_recipes;
+
+  /// Discharge compositions interpolated from the burnup table by (incommod
+  /// index, cycles in core) - filled in as they are needed.
+  mutable std::map<std::pair<int, int>, cyclus::Composition::Ptr>
+      burnup_comps;
+
+  /// True once the change schedules have passed the consistency checks.
+  bool checked;
+};
+
 /// Reactor is a simple, general reactor based on static compositional
 /// transformations to model fuel burnup.  The user specifies a set of input
 /// fuels and corresponding burnt compositions that fuel is transformed to when
@@ -19,11 +77,14 @@ namespace cycamore {
 /// requesting.  Changes in these preferences can be specified as a function of
 /// time using the pref_change variables.  Changes in the input-output recipe
 /// compositions can also be specified as a function of time using the
-/// recipe_change variables.
+/// recipe_change variables.  Fuel received on an input commodity with entries
+/// in the burnup table is instead transmuted to a composition interpolated
+/// from the table by the number of cycles it spent in the core.
 ///
-/// The reactor treats fuel as individual assemblies that are never split,
-/// combined or otherwise treated in any non-discrete way.  Fuel is requested
-/// in full-or-nothing assembly sized quanta.  If real-world assembly modeling
+/// The reactor models fuel as discrete assemblies - it orders, loads,
+/// discharges and trades whole assemblies only and never trades part of one
+/// or blends fuel of different compositions.  Fuel is requested in
+/// full-or-nothing assembly sized quanta.  If real-world assembly modeling
 /// is unnecessary, parameters can be adjusted (e.g. n_assem_core, assem_size,
 /// n_assem_batch).  At the end of every cycle, a full batch is discharged from
 /// the core consisting of n_assem_batch assemblies of assem_size kg. The
@@ -42,6 +103,13 @@ namespace cycamore {
 /// becomes full, the reactor will halt operation at the end of the next cycle
 /// until there is more room.  Each time step, the reactor will try to trade
 /// away as much of its spent fuel inventory as possible.
+///
+/// Internally, identical assemblies received together or discharged together
+/// are stored as a single lot - one material of n * assem_size kg - in the
+/// fresh, core and spent buffers.  Lots are split at batch boundaries when
+/// loading or discharging, and assemblies are split off spent fuel lots one
+/// at a time as they are traded away.  Lots only hold identical assemblies,
+/// so merging and splitting them never changes the modeled assemblies.
 class Reactor : public cyclus::Facility,
   public cyclus::toolkit::CommodityProducer {
 #pragma cyclus note { \
@@ -61,11 +129,15 @@ class Reactor : public cyclus::Facility,
   " requesting.  Changes in these preferences can be specified as a function of" \
   " time using the pref_change variables.  Changes in the input-output recipe" \
   " compositions can also be specified as a function of time using the" \
-  " recipe_change variables." \
+  " recipe_change variables.  Fuel received on an input commodity with" \
+  " entries in the burnup table is instead transmuted to a composition" \
+  " interpolated from the table by the number of cycles it spent in the" \
+  " core." \
   "\n\n" \
-  "The reactor treats fuel as individual assemblies that are never split," \
-  " combined or otherwise treated in any non-discrete way.  Fuel is requested" \
-  " in full-or-nothing assembly sized quanta.  If real-world assembly modeling" \
+  "The reactor models fuel as discrete assemblies - it orders, loads," \
+  " discharges and trades whole assemblies only and never trades part of one" \
+  " or blends fuel of different compositions.  Fuel is requested in" \
+  " full-or-nothing assembly sized quanta.  If real-world assembly modeling" \
   " is unnecessary, parameters can be adjusted (e.g. n_assem_core, assem_size," \
   " n_assem_batch).  At the end of every cycle, a full batch is discharged from" \
   " the core consisting of n_assem_batch assemblies of assem_size kg. The" \
@@ -93,6 +165,15 @@ class Reactor : public cyclus::Facility,
   virtual void Tick();
   virtual void Tock();
   virtual void EnterNotify();
+  virtual void Decommission();
+
+  /// Returns the next time step on which this reactor's Tick or Tock must do
+  /// more than advance cycle_step and record its power output: the end of
+  /// the current cycle or a scheduled preference/recipe change - whichever
+  /// comes first.  Returns the next time step when refueling, starting a
+  /// cycle or waiting for fuel.  Only valid after the Tock of the current
+  /// time step.
+  int NextEventTime();
 
   virtual void AcceptMatlTrades(const std::vector<std::pair<
       cyclus::Trade<cyclus::Material>, cyclus::Material::Ptr> >& responses);
@@ -111,6 +192,10 @@ class Reactor : public cyclus::Facility,
   #pragma cyclus decl
 
  private:
+  /// Returns the fuel info index of m - 0 if it has none.  Doesn't modify
+  /// res_indexes, so it is safe to use while bidding.
+  int fuel_index(cyclus::Material::Ptr m) const;
+
   std::string fuel_incommod(cyclus::Material::Ptr m);
   std::string fuel_outcommod(cyclus::Material::Ptr m);
   std::string fuel_inrecipe(cyclus::Material::Ptr m);
@@ -127,13 +212,63 @@ class Reactor : public cyclus::Facility,
   /// Top up core inventory as much as possible.
   void Load();
 
+  /// Returns the number of assemblies to order - enough to fill the core
+  /// and the fresh fuel inventory, plus the installments of the next batch
+  /// that are due if the cycle end is within order_window time steps.
+  int NOrder();
+
+  /// Makes room in the fresh fuel inventory for a batch ordered ahead of time
+  /// if order_window is set.
+  void SizeFresh();
+
+  /// Draws and schedules the time steps the reactor is down on into the
+  /// availability bitmap - if there are any.
+  void BuildAvailability();
+
+  /// Returns true if the reactor is not down on time step t.
+  inline bool Available(int t) {
+    return t >= static_cast<int>(avail_.size()) || avail_[t];
+  }
+
+  /// Returns the number of assemblies in qty kg of fuel.
+  inline int Assemblies(double qty) {
+    return static_cast<int>(qty / assem_size + 0.5);
+  }
+
+  /// Returns the number of assemblies in buf.
+  inline int Assemblies(const cyclus::toolkit::ResBuf<cyclus::Material>& buf) {
+    return Assemblies(buf.quantity());
+  }
+
+  /// Pops lots of n assemblies in total (or all of them if there are fewer)
+  /// from the front of buf - splitting the last one if it holds more than
+  /// are needed.  The number of lots popped whole is stored in whole if it is
+  /// not NULL.
+  cyclus::toolkit::MatVec PopAssemblies(
+      cyclus::toolkit::ResBuf<cyclus::Material>* buf, int n, int* whole);
+
+  /// Returns lots with each run of lots of the same composition and fuel
+  /// merged into a single lot.
+  cyclus::toolkit::MatVec Merge(const cyclus::toolkit::MatVec& lots);
+
   /// Transmute the batch that is about to be discharged from the core to its
-  /// fully burnt state as defined by its outrecipe.
+  /// fully burnt state as defined by its outrecipe - or the burnup table.
   void Transmute();
 
+  /// Returns the discharge composition of fuel received on incommod index i
+  /// after cycles cycles in the core, interpolated linearly (by mass) between
+  /// the nearest burnup table points of the incommod - or a null pointer if
+  /// the incommod has none.  Beyond the first or last point, the recipe of
+  /// that point is used.
+  cyclus::Composition::Ptr BurnupComp(int i, int cycles);
+
   /// Records a reactor event to the output db with the given name and note val.
   void Record(std::string name, std::string val);
 
+  /// Records the power output for the current time step - as a time series
+  /// or a power interval depending on power_intervals.
+  void RecordPower(double p);
+
   /// Complement of PopSpent - must be called with all materials passed that
   /// were not traded away to other agents.
   void PushSpent(std::map<std::string, cyclus::toolkit::MatVec> leftover);
@@ -146,6 +281,29 @@ class Reactor : public cyclus::Facility,
   /// from the spent fuel buffer.
   std::map<std::string, cyclus::toolkit::MatVec> PeekSpent();
 
+  /// Returns the composition of spent material m decayed from the last time
+  /// it was decayed - its discharge - to now.
+  cyclus::Composition::Ptr Decayed(cyclus::Material::Ptr m);
+
+  /// Returns the fuel configuration shared with this reactor's prototype.
+  const ReactorFuel& fuel();
+
+  /// Returns the fuel configuration for modification - copying it first if
+  /// it is shared.
+  ReactorFuel& mutable_fuel();
+
+  /// Moves the fuel state variables into a shared fuel configuration if they
+  /// are not there already.  Afterwards the state variables are empty.
+  void ShareFuel();
+
+  /// Stores the fuel index of every assembly in the fresh, core and spent
+  /// buffers (in that order) in res_index_runs.
+  void EncodeResIndexes();
+
+  /// Rebuilds res_indexes from res_index_runs for the assemblies currently in
+  /// the fresh, core and spent buffers.
+  void DecodeResIndexes();
+
 
   //////////// power params ////////////
   #pragma cyclus var { \
@@ -160,6 +318,59 @@ class Reactor : public cyclus::Facility,
     "doc": "The name of the 'power' commodity used in conjunction with a deployment curve.", \
   }
   std::string power_name;
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "doc": "If true, record power to the PowerIntervals table as one row per" \
+           " run of time steps with the same power output instead of one" \
+           " TimeSeriesPower row per time step.  The summed power of all" \
+           " such facilities in each region is recorded to the" \
+           " RegionPowerIntervals table.", \
+  }
+  bool power_intervals;
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "doc": "If true, spent fuel decays from the time it is discharged.  Decay" \
+           " is only applied when spent fuel is offered or traded away - idle" \
+           " spent fuel costs nothing - and decayed compositions are cached" \
+           " by spent fuel recipe and time since discharge.", \
+  }
+  bool decay_spent;
+
+  #pragma cyclus var { \
+    "default": 1, \
+    "doc": "Probability that the reactor is available on any time step - its" \
+           " capacity factor.  If it is less than 1, the reactor is down for a" \
+           " random subset of time steps drawn once when it is deployed.  No" \
+           " power is produced and the cycle makes no progress while it is" \
+           " down - outages lengthen the cycle.", \
+  }
+  double availability;
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "doc": "Seed for drawing the time steps the reactor is down on.  Reactors" \
+           " of the same prototype draw different outages from the same seed," \
+           " and rerunning a simulation draws the same ones.", \
+  }
+  int availability_seed;
+
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "Time steps on which scheduled outages start - in addition to any" \
+           " drawn at random.", \
+    "units": "time steps", \
+  }
+  std::vector<int> outage_starts;
+
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "Number of time steps each scheduled outage lasts." \
+           " Same order as and direct correspondence to the outage starts.", \
+    "units": "time steps", \
+  }
+  std::vector<int> outage_lengths;
   
   //////////// inventory and core params ////////////
   #pragma cyclus var { \
@@ -187,6 +398,16 @@ class Reactor : public cyclus::Facility,
     "doc": "Number of fresh fuel assemblies to keep on-hand if possible.", \
   }
   int n_assem_fresh;
+  #pragma cyclus var { \
+    "default": 0, \
+    "doc": "Number of time steps before the end of each cycle over which to" \
+           " order the fresh fuel of the next batch ahead of time - in evenly" \
+           " spread installments delivered to the fresh fuel inventory -" \
+           " instead of ordering it all when the cycle ends.  The default (0)" \
+           " is not to order ahead.", \
+    "units": "time steps", \
+  }
+  int order_window;
 
   ///////// cycle params ///////////
   #pragma cyclus var { \
@@ -298,17 +519,93 @@ class Reactor : public cyclus::Facility,
   }
   std::vector<std::string> recipe_change_out;
 
+  ///////////// burnup table ///////////
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "The input commodity of a burnup table point.  Fuel received on an" \
+           " input commodity with burnup table points is transmuted to a" \
+           " composition interpolated between them by the number of cycles" \
+           " it spent in the core instead of its output recipe.", \
+    "uitype": ["oneormore", "incommodity"], \
+  }
+  std::vector<std::string> burnup_commods;
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "The number of cycles in the core of a burnup table point." \
+           " Same order as and direct correspondence to the burnup table" \
+           " commodities.", \
+  }
+  std::vector<double> burnup_cycles;
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "The spent fuel recipe of a burnup table point." \
+           " Same order as and direct correspondence to the burnup table" \
+           " commodities.", \
+    "uitype": ["oneormore", "recipe"], \
+  }
+  std::vector<std::string> burnup_recipes;
+
   // should be hidden in ui (internal only). True if fuel has already been
   // discharged this cycle.
   #pragma cyclus var {"default": 0, "doc": "This should NEVER be set manually."}
   bool discharged;
 
-  // This variable should be hidden/unavailable in ui.  Maps resource object
-  // id's to the index for the incommod through which they were received.
-  #pragma cyclus var {"default": {}, "doc": "This should NEVER be set manually."}
+  // should be hidden in ui (internal only). True if the pref and recipe change
+  // schedules of this reactor were not snapshotted because they are the same
+  // as those of its prototype.
+  #pragma cyclus var {"default": 0, "doc": "This should NEVER be set manually."}
+  bool shared_schedules;
+
+  // should be hidden in ui (internal only). Start and value of the open power
+  // interval if power_intervals is set - start is negative if there is none.
+  #pragma cyclus var {"default": -1, "doc": "This should NEVER be set manually."}
+  int power_start;
+  #pragma cyclus var {"default": 0, "doc": "This should NEVER be set manually."}
+  double power_value;
+
+  // This variable should be hidden/unavailable in ui.  Run length encoded
+  // (count, index) pairs of the incommod index of each assembly in the fresh,
+  // core and spent buffers - in buffer order.  Only up to date in snapshots.
+  #pragma cyclus var {"default": [], "doc": "This should NEVER be set manually."}
+  std::vector<int> res_index_runs;
+
+  // should be hidden in ui (internal only). Number of cycles completed and
+  // the number that had been completed when each lot in the core was
+  // loaded - in core buffer order.
+  #pragma cyclus var {"default": 0, "doc": "This should NEVER be set manually."}
+  int n_cycles;
+  #pragma cyclus var {"default": [], "doc": "This should NEVER be set manually."}
+  std::vector<int> core_loaded;
+
+  // Shared fuel configuration - the fuel_* and *_change_* state variables
+  // only hold values while being read from or written to the database.
+  boost::shared_ptr<ReactorFuel> fuel_;
+
+  // Maps resource object id's to the index for the incommod through which
+  // they were received.  Not a state variable because object id's are not
+  // preserved across restarts - it is stored as res_index_runs instead.
   std::map<int, int> res_indexes;
+
+  // Fuel request targets and decayed spent fuel offers.
+  UntrackedPool targets_;
+  UntrackedPool offers_;
+
+  // Availability by time step - empty if the reactor is always available.
+  // Not a state variable: it is rebuilt from the outage parameters.
+  std::vector<bool> avail_;
+
+  // Time step on which the reactor next needs a full Tick/Tock - before it,
+  // the reactor is mid-cycle with nothing scheduled (see NextEventTime).
+  // Not a state variable: zero after restarts just costs one full step.
+  int wake_;
 };
 
+/// Run length encodes vals as (count, value) pairs.
+std::vector<int> RunLengthEncode(const std::vector<int>& vals);
+
+/// Inverse of RunLengthEncode.
+std::vector<int> RunLengthDecode(const std::vector<int>& runs);
+
 } // namespace cycamore
 
 #endif  // CYCAMORE_SRC_REACTOR_H_
@@ -0,0 +1,598 @@
+#include "reactor_fleet.h"
+
+#include "instrument.h"
+#include "power_intervals.h"
+#include "reactor.h"
+
+using cyclus::Material;
+using cyclus::Composition;
+using cyclus::toolkit::MatVec;
+using cyclus::ValueError;
+using cyclus::Request;
+
+namespace cycamore {
+
+ReactorFleet::ReactorFleet(cyclus::Context* ctx)
+    : cyclus::Facility(ctx),
+      n_assem_batch(0),
+      assem_size(0),
+      n_assem_core(0),
+      n_assem_spent(0),
+      n_assem_fresh(0),
+      cycle_time(0),
+      refuel_time(0),
+      cycle_step(0),
+      power_cap(0),
+      power_name("power"),
+      power_intervals(false),
+      power_start(-1),
+      power_value(0),
+      n_units(1) {
+  cyclus::Warn<cyclus::EXPERIMENTAL_WARNING>(
+      "the ReactorFleet archetype "
+      "is experimental");
+}
+
+#pragma cyclus def clone cycamore::ReactorFleet
+
+#pragma cyclus def schema cycamore::ReactorFleet
+
+#pragma cyclus def annotations cycamore::ReactorFleet
+
+#pragma cyclus def infiletodb cycamore::ReactorFleet
+
+void ReactorFleet::Snapshot(cyclus::DbInit di) {
+  std::vector<int> idx;
+  for (int u = 0; u < unit_n_fresh.size(); u++) {
+    int base = u * n_assem_fresh;
+    idx.insert(idx.end(), fresh_idx_.begin() + base,
+               fresh_idx_.begin() + base + unit_n_fresh[u]);
+  }
+  for (int u = 0; u < unit_n_core.size(); u++) {
+    int base = u * n_assem_core;
+    idx.insert(idx.end(), core_idx_.begin() + base,
+               core_idx_.begin() + base + unit_n_core[u]);
+  }
+  idx.insert(idx.end(), spent_idx_.begin(), spent_idx_.end());
+  res_index_runs = RunLengthEncode(idx);
+
+  const ReactorFuel& f = fuel();
+  fuel_incommods = f.incommods;
+  fuel_inrecipes = f.inrecipes;
+  fuel_outrecipes = f.outrecipes;
+  fuel_outcommods = f.outcommods;
+  fuel_prefs = f.prefs;
+  pref_change_times = f.pref_change_times;
+  pref_change_commods = f.pref_change_commods;
+  pref_change_values = f.pref_change_values;
+  recipe_change_times = f.recipe_change_times;
+  recipe_change_commods = f.recipe_change_commods;
+  recipe_change_in = f.recipe_change_in;
+  recipe_change_out = f.recipe_change_out;
+
+  #pragma cyclus impl snapshot cycamore::ReactorFleet
+
+  fuel_incommods.clear();
+  fuel_inrecipes.clear();
+  fuel_outrecipes.clear();
+  fuel_outcommods.clear();
+  fuel_prefs.clear();
+  pref_change_times.clear();
+  pref_change_commods.clear();
+  pref_change_values.clear();
+  recipe_change_times.clear();
+  recipe_change_commods.clear();
+  recipe_change_in.clear();
+  recipe_change_out.clear();
+  res_index_runs.clear();
+}
+
+cyclus::Inventories ReactorFleet::SnapshotInv() {
+  cyclus::Inventories invs;
+  std::vector<cyclus::Resource::Ptr>& fresh = invs["fresh"];
+  std::vector<cyclus::Resource::Ptr>& core = invs["core"];
+  for (int u = 0; u < unit_n_fresh.size(); u++) {
+    int base = u * n_assem_fresh;
+    fresh.insert(fresh.end(), fresh_.begin() + base,
+                 fresh_.begin() + base + unit_n_fresh[u]);
+  }
+  for (int u = 0; u < unit_n_core.size(); u++) {
+    int base = u * n_assem_core;
+    core.insert(core.end(), core_.begin() + base,
+                core_.begin() + base + unit_n_core[u]);
+  }
+  invs["spent"].assign(spent_.begin(), spent_.end());
+  return invs;
+}
+
+void ReactorFleet::InitInv(cyclus::Inventories& inv) {
+  Allocate();
+  std::vector<int> idx = RunLengthDecode(res_index_runs);
+  res_index_runs.clear();
+  idx.resize(inv["fresh"].size() + inv["core"].size() + inv["spent"].size());
+
+  int pos = 0;
+  int k = 0;
+  std::vector<cyclus::Resource::Ptr>& fresh = inv["fresh"];
+  for (int u = 0; u < n_units; u++) {
+    for (int i = 0; i < unit_n_fresh[u]; i++, k++, pos++) {
+      fresh_[u * n_assem_fresh + i] = cyclus::ResCast<Material>(fresh[k]);
+      fresh_idx_[u * n_assem_fresh + i] = idx[pos];
+    }
+  }
+
+  k = 0;
+  std::vector<cyclus::Resource::Ptr>& core = inv["core"];
+  for (int u = 0; u < n_units; u++) {
+    for (int i = 0; i < unit_n_core[u]; i++, k++, pos++) {
+      core_[u * n_assem_core + i] = cyclus::ResCast<Material>(core[k]);
+      core_idx_[u * n_assem_core + i] = idx[pos];
+    }
+  }
+
+  std::vector<cyclus::Resource::Ptr>& spent = inv["spent"];
+  for (int i = 0; i < spent.size(); i++, pos++) {
+    spent_.push_back(cyclus::ResCast<Material>(spent[i]));
+    spent_idx_.push_back(idx[pos]);
+    unit_n_spent_[spent_owner[i]]++;
+  }
+}
+
+void ReactorFleet::InitFrom(ReactorFleet* m) {
+  // as for Reactor - the fuel configuration is shared, not copied.
+  m->ShareFuel();
+  #pragma cyclus impl initfromcopy cycamore::ReactorFleet
+  fuel_ = m->fuel_;
+  cyclus::toolkit::CommodityProducer::Copy(m);
+}
+
+void ReactorFleet::InitFrom(cyclus::QueryableBackend* b) {
+  #pragma cyclus impl initfromdb cycamore::ReactorFleet
+
+  namespace tk = cyclus::toolkit;
+  tk::CommodityProducer::Add(
+      tk::Commodity(power_name),
+      tk::CommodInfo(power_cap * n_units, power_cap * n_units));
+}
+
+void ReactorFleet::EnterNotify() {
+  cyclus::Facility::EnterNotify();
+
+  // input consistency checking:
+  std::stringstream ss;
+  if (n_units < 1) {
+    ss << "prototype '" << prototype() << "' has " << n_units
+       << " units, expected at least 1\n";
+  }
+  const ReactorFuel& f = fuel();
+  if (!f.checked) {
+    ss << f.Check(prototype());
+  }
+  if (ss.str().size() > 0) {
+    throw cyclus::ValueError(ss.str());
+  }
+  fuel_->checked = true;
+
+  if (unit_cycle_step.empty()) {
+    unit_cycle_step.assign(n_units, cycle_step);
+  }
+  Allocate();
+}
+
+void ReactorFleet::Allocate() {
+  unit_cycle_step.resize(n_units, cycle_step);
+  unit_discharged.resize(n_units, 0);
+  unit_n_fresh.resize(n_units, 0);
+  unit_n_core.resize(n_units, 0);
+  unit_n_spent_.resize(n_units, 0);
+  fresh_.resize(n_units * n_assem_fresh);
+  fresh_idx_.resize(n_units * n_assem_fresh, 0);
+  core_.resize(n_units * n_assem_core);
+  core_idx_.resize(n_units * n_assem_core, 0);
+}
+
+void ReactorFleet::Tick() {
+  CYCAMORE_TIME("Tick");
+  if (power_intervals) {
+    JoinRegionPower(this);
+  }
+  // Same sequence as Reactor::Tick applied to every unit - see there.
+  int n_end = 0;
+  int n_transmute = 0;
+  int n_discharge = 0;
+  int n_failed = 0;
+  int n_load = 0;
+  for (int u = 0; u < n_units; u++) {
+    int step = unit_cycle_step[u];
+    if (step < cycle_time) {
+      continue;
+    }
+    if (step == cycle_time) {
+      n_transmute += Transmute(u);
+      n_end++;
+    }
+    if (!unit_discharged[u]) {
+      int n = Discharge(u);
+      if (n < 0) {
+        n_failed++;
+      } else {
+        n_discharge += n;
+        unit_discharged[u] = 1;
+      }
+    }
+    n_load += Load(u);
+  }
+  Record("TRANSMUTE", n_transmute, "assemblies");
+  Record("CYCLE_END", n_end, "units");
+  Record("DISCHARGE", n_discharge, "assemblies");
+  // one event per unit, as the Reactor records it
+  for (int u = 0; u < n_failed; u++) {
+    Record("DISCHARGE", "failed");
+  }
+  Record("LOAD", n_load, "assemblies");
+
+  int t = context()->time();
+  if (fuel().ChangesAt(t)) {
+    mutable_fuel().ApplyChanges(t);
+  }
+}
+
+std::set<cyclus::RequestPortfolio<Material>::Ptr>
+ReactorFleet::GetMatlRequests() {
+  CYCAMORE_TIME("GetMatlRequests");
+  using cyclus::RequestPortfolio;
+
+  std::set<RequestPortfolio<Material>::Ptr> ports;
+
+  int n_assem_order = 0;
+  for (int u = 0; u < n_units; u++) {
+    n_assem_order += n_assem_core - unit_n_core[u] + n_assem_fresh -
+                     unit_n_fresh[u];
+  }
+  if (n_assem_order == 0) {
+    return ports;
+  }
+
+  // request targets are never modified - one per fuel serves every request
+  targets_.Reset(context()->time());
+  const ReactorFuel& f = fuel();
+  MatVec targets;
+  for (int j = 0; j < f.incommods.size(); j++) {
+    Composition::Ptr recipe = context()->GetRecipe(f.inrecipes[j]);
+    targets.push_back(targets_.Get(assem_size, recipe));
+  }
+
+  for (int i = 0; i < n_assem_order; i++) {
+    RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
+    std::vector<Request<Material>*> mreqs;
+    for (int j = 0; j < f.incommods.size(); j++) {
+      Request<Material>* r = port->AddRequest(targets[j], this,
+                                              f.incommods[j], f.prefs[j],
+                                              true);
+      mreqs.push_back(r);
+    }
+    port->AddMutualReqs(mreqs);
+    ports.insert(port);
+  }
+
+  CYCAMORE_COUNT_REQUESTS(ports);
+  return ports;
+}
+
+void ReactorFleet::GetMatlTrades(
+    const std::vector<cyclus::Trade<Material> >& trades,
+    std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
+        responses) {
+  CYCAMORE_TIME("GetMatlTrades");
+
+  // positions in the spent pool of the assemblies of each outcommod, oldest
+  // first
+  const std::vector<std::string>& outcommods = fuel().outcommods;
+  std::map<std::string, std::vector<int> > avail;
+  for (int i = 0; i < spent_.size(); i++) {
+    avail[outcommods[spent_idx_[i]]].push_back(i);
+  }
+  std::map<std::string, int> next;
+
+  std::vector<bool> traded(spent_.size(), false);
+  for (int i = 0; i < trades.size(); i++) {
+    std::string commod = trades[i].request->commodity();
+    int& k = next[commod];
+    const std::vector<int>& pos = avail[commod];
+    if (k >= pos.size()) {
+      throw ValueError("cycamore::ReactorFleet - trade for more spent fuel "
+                       "than offered");
+    }
+    int p = pos[k++];
+    traded[p] = true;
+    responses.push_back(std::make_pair(trades[i], spent_[p]));
+  }
+
+  // compact the pool keeping the untraded assemblies in order
+  int n = 0;
+  for (int i = 0; i < spent_.size(); i++) {
+    if (traded[i]) {
+      unit_n_spent_[spent_owner[i]]--;
+      continue;
+    }
+    spent_[n] = spent_[i];
+    spent_idx_[n] = spent_idx_[i];
+    spent_owner[n] = spent_owner[i];
+    n++;
+  }
+  spent_.resize(n);
+  spent_idx_.resize(n);
+  spent_owner.resize(n);
+}
+
+void ReactorFleet::AcceptMatlTrades(const std::vector<
+    std::pair<cyclus::Trade<Material>, Material::Ptr> >& responses) {
+  CYCAMORE_TIME("AcceptMatlTrades");
+
+  // fill cores first, then fresh inventories - in unit order
+  int uc = 0;
+  int uf = 0;
+  int nload = 0;
+  for (int i = 0; i < responses.size(); i++) {
+    Material::Ptr m = responses[i].second;
+    int idx = fuel_index(responses[i].first.request->commodity());
+
+    while (uc < n_units && unit_n_core[uc] >= n_assem_core) {
+      uc++;
+    }
+    if (uc < n_units) {
+      int slot = uc * n_assem_core + unit_n_core[uc]++;
+      core_[slot] = m;
+      core_idx_[slot] = idx;
+      nload++;
+      continue;
+    }
+
+    while (uf < n_units && unit_n_fresh[uf] >= n_assem_fresh) {
+      uf++;
+    }
+    if (uf == n_units) {
+      throw ValueError("cycamore::ReactorFleet - received more fuel than "
+                       "requested");
+    }
+    int slot = uf * n_assem_fresh + unit_n_fresh[uf]++;
+    fresh_[slot] = m;
+    fresh_idx_[slot] = idx;
+  }
+  Record("LOAD", nload, "assemblies");
+}
+
+std::set<cyclus::BidPortfolio<Material>::Ptr> ReactorFleet::GetMatlBids(
+    cyclus::CommodMap<Material>::type& commod_requests) {
+  CYCAMORE_TIME("GetMatlBids");
+  using cyclus::BidPortfolio;
+
+  std::set<BidPortfolio<Material>::Ptr> ports;
+  if (spent_.empty()) {
+    return ports;
+  }
+
+  // several fuels may share an outcommod - offer each outcommod once
+  const std::vector<std::string>& outcommods = fuel().outcommods;
+  std::set<std::string> commods(outcommods.begin(), outcommods.end());
+  std::set<std::string>::iterator it;
+  for (it = commods.begin(); it != commods.end(); ++it) {
+    std::string commod = *it;
+    cyclus::CommodMap<Material>::type::const_iterator found =
+        commod_requests.find(commod);
+    if (found == commod_requests.end() || found->second.size() == 0) {
+      continue;
+    }
+    const std::vector<Request<Material>*>& reqs = found->second;
+
+    MatVec mats;
+    for (int i = 0; i < spent_.size(); i++) {
+      if (outcommods[spent_idx_[i]] == commod) {
+        mats.push_back(spent_[i]);
+      }
+    }
+    if (mats.size() == 0) {
+      continue;
+    }
+
+    BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
+
+    for (int j = 0; j < reqs.size(); j++) {
+      Request<Material>* req = reqs[j];
+      double tot_bid = 0;
+      for (int k = 0; k < mats.size(); k++) {
+        Material::Ptr m = mats[k];
+        tot_bid += m->quantity();
+        port->AddBid(req, m, this, true);
+        if (tot_bid >= req->target()->quantity()) {
+          break;
+        }
+      }
+    }
+
+    double tot_qty = 0;
+    for (int j = 0; j < mats.size(); j++) {
+      tot_qty += mats[j]->quantity();
+    }
+    cyclus::CapacityConstraint<Material> cc(tot_qty);
+    port->AddConstraint(cc);
+    ports.insert(port);
+  }
+
+  CYCAMORE_COUNT_BIDS(ports);
+  return ports;
+}
+
+void ReactorFleet::Tock() {
+  CYCAMORE_TIME("Tock");
+  // Same sequence as Reactor::Tock applied to every unit - see there.
+  int n_start = 0;
+  int n_operating = 0;
+  for (int u = 0; u < n_units; u++) {
+    int& step = unit_cycle_step[u];
+    bool full = unit_n_core[u] == n_assem_core;
+    if (step >= cycle_time + refuel_time && full) {
+      unit_discharged[u] = 0;
+      step = 0;
+    }
+    if (step == 0 && full) {
+      n_start++;
+    }
+    if (step >= 0 && step < cycle_time && full) {
+      n_operating++;
+    }
+    if (step > 0 || full) {
+      step++;
+    }
+  }
+  Record("CYCLE_START", n_start, "units");
+
+  RecordPower(power_cap * n_operating);
+}
+
+int ReactorFleet::Transmute(int u) {
+  // safe to assume full core.
+  int base = u * n_assem_core;
+  int n = std::min(n_assem_batch, unit_n_core[u]);
+  for (int i = base; i < base + n; i++) {
+    core_[i]->Transmute(
+        context()->GetRecipe(fuel().outrecipes[core_idx_[i]]));
+  }
+  return n;
+}
+
+int ReactorFleet::Discharge(int u) {
+  if (n_assem_spent - unit_n_spent_[u] < n_assem_batch) {
+    return -1;  // not enough room in spent buffer
+  }
+
+  int base = u * n_assem_core;
+  int npop = std::min(n_assem_batch, unit_n_core[u]);
+  for (int i = base; i < base + npop; i++) {
+    spent_.push_back(core_[i]);
+    spent_idx_.push_back(core_idx_[i]);
+    spent_owner.push_back(u);
+  }
+  int n = unit_n_core[u] - npop;
+  for (int i = base; i < base + n; i++) {
+    core_[i] = core_[i + npop];
+    core_idx_[i] = core_idx_[i + npop];
+  }
+  for (int i = base + n; i < base + unit_n_core[u]; i++) {
+    core_[i].reset();
+  }
+  unit_n_core[u] = n;
+  unit_n_spent_[u] += npop;
+  return npop;
+}
+
+int ReactorFleet::Load(int u) {
+  int n = std::min(n_assem_core - unit_n_core[u], unit_n_fresh[u]);
+  if (n == 0) {
+    return 0;
+  }
+
+  int cbase = u * n_assem_core + unit_n_core[u];
+  int fbase = u * n_assem_fresh;
+  for (int i = 0; i < n; i++) {
+    core_[cbase + i] = fresh_[fbase + i];
+    core_idx_[cbase + i] = fresh_idx_[fbase + i];
+  }
+  int left = unit_n_fresh[u] - n;
+  for (int i = 0; i < left; i++) {
+    fresh_[fbase + i] = fresh_[fbase + n + i];
+    fresh_idx_[fbase + i] = fresh_idx_[fbase + n + i];
+  }
+  for (int i = left; i < unit_n_fresh[u]; i++) {
+    fresh_[fbase + i].reset();
+  }
+  unit_n_core[u] += n;
+  unit_n_fresh[u] = left;
+  return n;
+}
+
+int ReactorFleet::fuel_index(std::string incommod) {
+  int i = fuel().index(incommod);
+  if (i < 0) {
+    throw ValueError(
+        "cycamore::ReactorFleet - received unsupported incommod material");
+  }
+  return i;
+}
+
+const ReactorFuel& ReactorFleet::fuel() {
+  if (!fuel_) {
+    ShareFuel();
+  }
+  return *fuel_;
+}
+
+ReactorFuel& ReactorFleet::mutable_fuel() {
+  if (!fuel_) {
+    ShareFuel();
+  } else if (!fuel_.unique()) {
+    fuel_.reset(new ReactorFuel(*fuel_));
+  }
+  return *fuel_;
+}
+
+void ReactorFleet::ShareFuel() {
+  if (fuel_) {
+    return;
+  }
+
+  fuel_.reset(new ReactorFuel());
+  fuel_->incommods.swap(fuel_incommods);
+  fuel_->inrecipes.swap(fuel_inrecipes);
+  fuel_->outrecipes.swap(fuel_outrecipes);
+  fuel_->outcommods.swap(fuel_outcommods);
+  fuel_->prefs.swap(fuel_prefs);
+  fuel_->pref_change_times.swap(pref_change_times);
+  fuel_->pref_change_commods.swap(pref_change_commods);
+  fuel_->pref_change_values.swap(pref_change_values);
+  fuel_->recipe_change_times.swap(recipe_change_times);
+  fuel_->recipe_change_commods.swap(recipe_change_commods);
+  fuel_->recipe_change_in.swap(recipe_change_in);
+  fuel_->recipe_change_out.swap(recipe_change_out);
+  fuel_->DefaultPrefs();
+}
+
+void ReactorFleet::Record(std::string name, int n, std::string what) {
+  if (n == 0) {
+    return;
+  }
+  std::stringstream ss;
+  ss << n << " " << what;
+  Record(name, ss.str());
+}
+
+void ReactorFleet::Record(std::string name, std::string val) {
+  context()
+      ->NewDatum("ReactorEvents")
+      ->AddVal("AgentId", id())
+      ->AddVal("Time", context()->time())
+      ->AddVal("Event", name)
+      ->AddVal("Value", val)
+      ->Record();
+}
+
+void ReactorFleet::RecordPower(double p) {
+  if (power_intervals) {
+    RecordPowerInterval(this, p, &power_start, &power_value);
+  } else {
+    cyclus::toolkit::RecordTimeSeries<cyclus::toolkit::POWER>(this, p);
+  }
+}
+
+void ReactorFleet::Decommission() {
+  if (power_intervals) {
+    ClosePowerInterval(this, &power_start, &power_value);
+  }
+  cyclus::Facility::Decommission();
+}
+
+extern "C" cyclus::Agent* ConstructReactorFleet(cyclus::Context* ctx) {
+  return new ReactorFleet(ctx);
+}
+
+}  // namespace cycamore
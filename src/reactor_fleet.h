@@ -0,0 +1,340 @@
+#ifndef CYCAMORE_SRC_REACTOR_FLEET_H_
+#define CYCAMORE_SRC_REACTOR_FLEET_H_
+
+#include <boost/shared_ptr.hpp>
+
+#include "cyclus.h"
+#include "untracked_pool.h"
+
+namespace cycamore {
+
+struct ReactorFuel;
+
+/// ReactorFleet models n_units identical reactors as a single agent.  Each
+/// unit behaves like a cycamore Reactor with the same parameters: it runs
+/// operational cycles of cycle_time steps, discharges and transmutes a batch
+/// of n_assem_batch assemblies at the end of each cycle, refuels for
+/// refuel_time steps and resumes once its core is full.  All units share the
+/// fuel specifications and the pref/recipe change schedules, which are
+/// checked and applied exactly as for Reactor.
+///
+/// The per-unit state (cycle step, discharged flag and inventory counts) is
+/// kept in flat arrays indexed by unit, and the fresh and core assemblies of
+/// all units in flat arrays of fixed size slots per unit.  Spent assemblies
+/// of all units are pooled in discharge order.  The fleet makes one request
+/// portfolio per missing assembly across all of its units, offers its pooled
+/// spent fuel in a single portfolio per output commodity and records its
+/// power and reactor events once per time step for the whole fleet - at a
+/// fraction of the cost of as many separate Reactor agents.
+///
+/// Received fresh fuel goes to the units in order: first to any unit whose
+/// core is not full, then to any unit whose fresh fuel inventory is not full.
+/// Spent fuel is traded away oldest first regardless of the unit it came
+/// from.
+class ReactorFleet : public cyclus::Facility,
+  public cyclus::toolkit::CommodityProducer {
+#pragma cyclus note { \
+"niche": "reactor", \
+"doc": \
+  "ReactorFleet models n_units identical reactors as a single agent.  Each" \
+  " unit behaves like a cycamore Reactor with the same parameters: it runs" \
+  " operational cycles of cycle_time steps, discharges and transmutes a batch" \
+  " of n_assem_batch assemblies at the end of each cycle, refuels for" \
+  " refuel_time steps and resumes once its core is full.  All units share the" \
+  " fuel specifications and the pref/recipe change schedules." \
+  "\n\n" \
+  "Received fresh fuel goes to the units in order: first to any unit whose" \
+  " core is not full, then to any unit whose fresh fuel inventory is not full." \
+  " Spent fuel is traded away oldest first regardless of the unit it came" \
+  " from.  Power and reactor events are recorded for the fleet as a whole.", \
+}
+
+ public:
+  ReactorFleet(cyclus::Context* ctx);
+  virtual ~ReactorFleet(){};
+
+  virtual void Tick();
+  virtual void Tock();
+  virtual void EnterNotify();
+  virtual void Decommission();
+
+  virtual void AcceptMatlTrades(const std::vector<std::pair<
+      cyclus::Trade<cyclus::Material>, cyclus::Material::Ptr> >& responses);
+
+  virtual std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>
+  GetMatlRequests();
+
+  virtual std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> GetMatlBids(
+      cyclus::CommodMap<cyclus::Material>::type& commod_requests);
+
+  virtual void GetMatlTrades(
+      const std::vector<cyclus::Trade<cyclus::Material> >& trades,
+      std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                            cyclus::Material::Ptr> >& responses);
+
+  #pragma cyclus decl
+
+ private:
+  /// Returns the fuel index for incommod.
+  /// @throws cyclus::ValueError if incommod is not a fuel input commodity
+  int fuel_index(std::string incommod);
+
+  /// Returns the fuel configuration shared with this fleet's prototype.
+  const ReactorFuel& fuel();
+
+  /// Returns the fuel configuration for modification - copying it first if
+  /// it is shared.
+  ReactorFuel& mutable_fuel();
+
+  /// Moves the fuel state variables into a shared fuel configuration if they
+  /// are not there already.  Afterwards the state variables are empty.
+  void ShareFuel();
+
+  /// Sizes the per-unit arrays and assembly slots for n_units units.
+  void Allocate();
+
+  /// Transmutes the batch that is about to be discharged from the core of
+  /// unit u.  Returns the number of assemblies transmuted.
+  int Transmute(int u);
+
+  /// Discharges a batch from the core of unit u if it has room for it in its
+  /// share of the spent fuel inventory.  Returns the number of assemblies
+  /// discharged, or -1 if there was no room.
+  int Discharge(int u);
+
+  /// Tops up the core of unit u from its fresh fuel as much as possible.
+  /// Returns the number of assemblies loaded.
+  int Load(int u);
+
+  /// Records a fleet event to the output db if n is nonzero.
+  void Record(std::string name, int n, std::string what);
+
+  /// Records a reactor event to the output db.
+  void Record(std::string name, std::string val);
+
+  /// Records the power output for the current time step - as a time series
+  /// or a power interval depending on power_intervals.
+  void RecordPower(double p);
+
+  //////////// power params ////////////
+  #pragma cyclus var { \
+    "default": 0, \
+    "doc": "Amount of electrical power the facility produces when operating normally.", \
+    "units": "MWe", \
+  }
+  double power_cap;
+
+  #pragma cyclus var { \
+    "default": "power", \
+    "doc": "The name of the 'power' commodity used in conjunction with a deployment curve.", \
+  }
+  std::string power_name;
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "doc": "If true, record power to the PowerIntervals table as one row per" \
+           " run of time steps with the same power output instead of one" \
+           " TimeSeriesPower row per time step.  The summed power of all" \
+           " such facilities in each region is recorded to the" \
+           " RegionPowerIntervals table.", \
+  }
+  bool power_intervals;
+  
+  //////////// inventory and core params ////////////
+  #pragma cyclus var { \
+    "doc": "Number of assemblies that constitute a single batch." \
+           "This is the number of assemblies discharged from the core fully burned each cycle." \
+           "Batch size is equivalent to ``n_assem_batch / n_assem_core``.", \
+  }
+  int n_assem_batch;
+  #pragma cyclus var { \
+    "doc": "Mass (kg) of a single assembly.", \
+    "units": "kg", \
+  }
+  double assem_size;
+  #pragma cyclus var { \
+    "doc": "Number of assemblies that constitute a full core.", \
+  }
+  int n_assem_core;
+  #pragma cyclus var { \
+    "default": 1000000000, \
+    "doc": "Number of spent fuel assemblies that can be stored on-site before reactor operation stalls.", \
+  }
+  int n_assem_spent;
+  #pragma cyclus var { \
+    "default": 0, \
+    "doc": "Number of fresh fuel assemblies to keep on-hand if possible.", \
+  }
+  int n_assem_fresh;
+
+  ///////// cycle params ///////////
+  #pragma cyclus var { \
+    "doc": "The duration of a full operational cycle (excluding refueling time) in time steps.", \
+    "units": "time steps", \
+  }
+  int cycle_time;
+  #pragma cyclus var { \
+    "doc": "The duration of a full refueling period - the minimum time between" \
+           " a cycle end and the start of the next cycle.", \
+    "units": "time steps", \
+  }
+  int refuel_time;
+  #pragma cyclus var { \
+    "default": 0, \
+    "doc": "Number of time steps since the start of the last cycle that every" \
+           " unit of the fleet is deployed with." \
+           " Only set this if you know what you are doing", \
+    "units": "time steps", \
+  }
+  int cycle_step;
+
+  /////// fuel specifications /////////
+  #pragma cyclus var { \
+    "uitype": ["oneormore", "incommodity"], \
+    "doc": "Ordered list of input commodities on which to requesting fuel.", \
+  }
+  std::vector<std::string> fuel_incommods;
+  #pragma cyclus var { \
+    "uitype": ["oneormore", "recipe"], \
+    "doc": "Fresh fuel recipes to request for each of the given fuel input commodities (same order).", \
+  }
+  std::vector<std::string> fuel_inrecipes;
+  #pragma cyclus var { \
+    "uitype": ["oneormore", "recipe"], \
+    "doc": "Spent fuel recipes corresponding to the given fuel input commodities (same order)." \
+           " Fuel received via a particular input commodity is transmuted to the recipe specified" \
+           " here after being burned during a cycle.", \
+  }
+  std::vector<std::string> fuel_outrecipes;
+  #pragma cyclus var { \
+    "uitype": ["oneormore", "incommodity"], \
+    "doc": "Output commodities on which to offer spent fuel originally received as each particular " \
+           " input commodity (same order)." \
+  }
+  std::vector<std::string> fuel_outcommods;
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "The preference for each type of fresh fuel requested corresponding to each input" \
+           " commodity (same order).  If no preferences are specified, zero is" \
+           " used for all fuel requests (default).", \
+  }
+  std::vector<double> fuel_prefs;
+
+  ////////// fleet params //////////
+  #pragma cyclus var { \
+    "default": 1, \
+    "doc": "Number of identical reactor units in the fleet.", \
+  }
+  int n_units;
+
+  /////////// preference changes ///////////
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "A time step on which to change the request preference for a " \
+           "particular fresh fuel type.", \
+  }
+  std::vector<int> pref_change_times;
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "The input commodity for a particular fuel preference change." \
+           " Same order as and direct correspondence to the specified preference change times.", \
+    "uitype": ["oneormore", "incommodity"], \
+  }
+  std::vector<std::string> pref_change_commods;
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "The new/changed request preference for a particular fresh fuel." \
+           " Same order as and direct correspondence to the specified preference change times.", \
+  }
+  std::vector<double> pref_change_values;
+
+  ///////////// recipe changes ///////////
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "A time step on which to change the input-output recipe pair for a requested fresh fuel.", \
+  }
+  std::vector<int> recipe_change_times;
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "The input commodity indicating fresh fuel for which recipes will be changed." \
+           " Same order as and direct correspondence to the specified recipe change times.", \
+    "uitype": ["oneormore", "incommodity"], \
+  }
+  std::vector<std::string> recipe_change_commods;
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "The new input recipe to use for this recipe change." \
+           " Same order as and direct correspondence to the specified recipe change times.", \
+    "uitype": ["oneormore", "recipe"], \
+  }
+  std::vector<std::string> recipe_change_in;
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "The new output recipe to use for this recipe change." \
+           " Same order as and direct correspondence to the specified recipe change times.", \
+    "uitype": ["oneormore", "recipe"], \
+  }
+  std::vector<std::string> recipe_change_out;
+
+  // should be hidden in ui (internal only). Per-unit cycle steps.
+  #pragma cyclus var {"default": [], "doc": "This should NEVER be set manually."}
+  std::vector<int> unit_cycle_step;
+
+  // should be hidden in ui (internal only). Per-unit flags (0 or 1) - true if
+  // fuel has already been discharged this cycle.
+  #pragma cyclus var {"default": [], "doc": "This should NEVER be set manually."}
+  std::vector<int> unit_discharged;
+
+  // should be hidden in ui (internal only). Per-unit fresh fuel assembly
+  // counts.
+  #pragma cyclus var {"default": [], "doc": "This should NEVER be set manually."}
+  std::vector<int> unit_n_fresh;
+
+  // should be hidden in ui (internal only). Per-unit core assembly counts.
+  #pragma cyclus var {"default": [], "doc": "This should NEVER be set manually."}
+  std::vector<int> unit_n_core;
+
+  // should be hidden in ui (internal only). The unit each pooled spent
+  // assembly was discharged from - in pool order.
+  #pragma cyclus var {"default": [], "doc": "This should NEVER be set manually."}
+  std::vector<int> spent_owner;
+
+  // This variable should be hidden/unavailable in ui.  Run length encoded
+  // (count, index) pairs of the incommod index of each fresh, core and spent
+  // assembly - in inventory order.  Only up to date in snapshots.
+  #pragma cyclus var {"default": [], "doc": "This should NEVER be set manually."}
+  std::vector<int> res_index_runs;
+
+  // should be hidden in ui (internal only). Start and value of the open power
+  // interval if power_intervals is set - start is negative if there is none.
+  #pragma cyclus var {"default": -1, "doc": "This should NEVER be set manually."}
+  int power_start;
+  #pragma cyclus var {"default": 0, "doc": "This should NEVER be set manually."}
+  double power_value;
+
+  // Fresh and core assemblies - n_assem_fresh and n_assem_core slots per unit
+  // respectively, oldest first, with the unit_n_* counts in use.  The *_idx_
+  // arrays hold the incommod index of the assembly in each slot.
+  cyclus::toolkit::MatVec fresh_;
+  std::vector<int> fresh_idx_;
+  cyclus::toolkit::MatVec core_;
+  std::vector<int> core_idx_;
+
+  // Shared fuel configuration - the fuel_* and *_change_* state variables
+  // only hold values while being read from or written to the database.
+  boost::shared_ptr<ReactorFuel> fuel_;
+
+  // Pooled spent assemblies of all units, oldest first.
+  cyclus::toolkit::MatVec spent_;
+  std::vector<int> spent_idx_;
+
+  // Per-unit spent assembly counts.
+  std::vector<int> unit_n_spent_;
+
+  // Fuel request targets.
+  UntrackedPool targets_;
+};
+
+} // namespace cycamore
+
+#endif  // CYCAMORE_SRC_REACTOR_FLEET_H_
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "cyclus.h"
+
+using pyne::nucname::id;
+using cyclus::Composition;
+using cyclus::QueryResult;
+using cyclus::Cond;
+
+namespace cycamore {
+namespace reactorfleettests {
+
+Composition::Ptr c_uox() {
+  cyclus::CompMap m;
+  m[id("u235")] = 0.04;
+  m[id("u238")] = 0.96;
+  return Composition::CreateFromMass(m);
+};
+
+Composition::Ptr c_spentuox() {
+  cyclus::CompMap m;
+  m[id("u235")] =  .8;
+  m[id("u238")] =  100;
+  m[id("pu239")] = 1;
+  return Composition::CreateFromMass(m);
+};
+
+const std::string fuel =
+    "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+    "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+    "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+    "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+    "  <assem_size>1</assem_size>  ";
+
+std::string config(int n_units, std::string extra) {
+  std::stringstream ss;
+  ss << fuel << "  <n_units>" << n_units << "</n_units>  " << extra;
+  return ss.str();
+}
+
+int n_transactions(std::string spec, std::string config, int simdur) {
+  cyclus::MockSim sim(cyclus::AgentSpec(spec), config, simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddSink("waste").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  sim.Run();
+  std::vector<Cond> conds;
+  conds.push_back(Cond("Commodity", "==", std::string("uox")));
+  return sim.db().Query("Transactions", &conds).rows.size();
+}
+
+// tests that the correct number of assemblies are popped from the core of
+// every unit each cycle.
+TEST(ReactorFleetTests, BatchSizes) {
+  std::string cfg = config(4,
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <n_assem_core>7</n_assem_core>  "
+     "  <n_assem_batch>3</n_assem_batch>  ");
+
+  int simdur = 50;
+  // 7 for initial core, 3 per time step for each new batch for remainder
+  EXPECT_EQ(4 * (7+3*(simdur-1)),
+            n_transactions(":cycamore:ReactorFleet", cfg, simdur));
+}
+
+// tests that the refueling period between cycle end and start of the next
+// cycle is honored by every unit.
+TEST(ReactorFleetTests, RefuelTimes) {
+  std::string cfg = config(3,
+     "  <cycle_time>4</cycle_time>  "
+     "  <refuel_time>3</refuel_time>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  ");
+
+  int simdur = 49;
+  int cyclet = 4;
+  int refuelt = 3;
+  int n_assem_want = simdur/(cyclet+refuelt)+1; // +1 for initial core
+  EXPECT_EQ(3 * n_assem_want,
+            n_transactions(":cycamore:ReactorFleet", cfg, simdur));
+}
+
+// tests that every unit halts operation when it has no more room in its
+// spent fuel inventory.
+TEST(ReactorFleetTests, FullSpentInventory) {
+  std::string cfg = config(5,
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <n_assem_spent>3</n_assem_spent>  ");
+
+  int simdur = 10;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:ReactorFleet"), cfg,
+                      simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  sim.Run();
+
+  QueryResult qr = sim.db().Query("Transactions", NULL);
+  // +1 is for the assembly in the core + the three in spent
+  EXPECT_EQ(5 * (3+1), qr.rows.size());
+}
+
+// a fleet should order the same fuel as the same number of separate reactors
+// when fuel is plentiful.
+TEST(ReactorFleetTests, MatchesReactors) {
+  std::string params =
+     "  <cycle_time>5</cycle_time>  "
+     "  <refuel_time>2</refuel_time>  "
+     "  <n_assem_core>4</n_assem_core>  "
+     "  <n_assem_batch>2</n_assem_batch>  "
+     "  <n_assem_fresh>1</n_assem_fresh>  ";
+
+  int simdur = 40;
+  int n_units = 6;
+  int single = n_transactions(":cycamore:Reactor", fuel + params, simdur);
+  EXPECT_EQ(n_units * single,
+            n_transactions(":cycamore:ReactorFleet", config(n_units, params),
+                           simdur));
+}
+
+// the fleet records the power of all of its operating units.
+TEST(ReactorFleetTests, Power) {
+  std::string cfg = config(3,
+     "  <cycle_time>3</cycle_time>  "
+     "  <refuel_time>1</refuel_time>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <power_cap>100</power_cap>  ");
+
+  int simdur = 8;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:ReactorFleet"), cfg,
+                      simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddSink("waste").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int id = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", id));
+  QueryResult qr = sim.db().Query("TimeSeriesPower", &conds);
+  ASSERT_EQ(simdur, qr.rows.size());
+  // units load at time 0 and operate for 3 steps, then refuel for 1
+  double want[] = {300, 300, 300, 0, 300, 300, 300, 0};
+  for (int i = 0; i < qr.rows.size(); i++) {
+    int t = qr.GetVal<int>("Time", i);
+    EXPECT_DOUBLE_EQ(want[t], qr.GetVal<double>("Value", i)) << "t=" << t;
+  }
+}
+
+} // namespace reactorfleettests
+} // namespace cycamore
@@ -2,7 +2,11 @@
 
 #include <sstream>
 
+#include "alloc_counter.h"
 #include "cyclus.h"
+#include "decay_cache.h"
+#include "parallel_bids.h"
+#include "reactor.h"
 
 using pyne::nucname::id;
 using cyclus::Composition;
@@ -80,6 +84,49 @@ TEST(ReactorTests, JustInTimeOrdering) {
   EXPECT_EQ(simdur, qr.rows.size()) << "failed to order+run on fresh fuel inside 1 time step";
 }
 
+// With an order window, the next batch is ordered in installments over the
+// last time steps of each cycle instead of all at once at its end - and the
+// next cycle still starts without delay.
+TEST(ReactorTests, OrderWindow) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>4</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>3</n_assem_core>  "
+     "  <n_assem_batch>3</n_assem_batch>  "
+     "  <order_window>3</order_window>  ";
+
+  int simdur = 9;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int aid = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("ReceiverId", "==", aid));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  std::map<int, int> n;
+  for (int i = 0; i < qr.rows.size(); i++) {
+    n[qr.GetVal<int>("Time", i)]++;
+  }
+  int want[] = {3, 1, 1, 1, 0, 1, 1, 1, 0};
+  for (int t = 0; t < simdur; t++) {
+    EXPECT_EQ(want[t], n[t]) << "time step " << t;
+  }
+
+  conds.clear();
+  conds.push_back(Cond("AgentId", "==", aid));
+  conds.push_back(Cond("Event", "==", std::string("CYCLE_START")));
+  qr = sim.db().Query("ReactorEvents", &conds);
+  EXPECT_EQ(3, qr.rows.size());
+}
+
 // tests that the correct number of assemblies are popped from the core each
 // cycle.
 TEST(ReactorTests, BatchSizes) {
@@ -317,6 +364,133 @@ TEST(ReactorTests, DischargedFuelTransmute) {
   EXPECT_TRUE(mq.mass(942390000) > 0) << "transmuted spent fuel doesn't have Pu239";
 }
 
+// Spent fuel traded some time after discharge is decayed for that time - and
+// only when it is traded.
+TEST(ReactorTests, DecaySpent) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>4</cycle_time>  "
+     "  <refuel_time>3</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <decay_spent>1</decay_spent>  ";
+
+  int simdur = 7;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").Finalize();
+  // discharged at time step 4 and traded at 6
+  sim.AddSink("waste").start(6).Finalize();
+  sim.AddRecipe("uox", c_uox());
+  cyclus::CompMap v;
+  v[id("u238")] = 100;
+  v[id("pu241")] = 1;
+  Composition::Ptr spentuox = Composition::CreateFromMass(v);
+  sim.AddRecipe("spentuox", spentuox);
+  int aid = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("SenderId", "==", aid));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ(6, qr.GetVal<int>("Time"));
+  Material::Ptr m = sim.GetMaterial(qr.GetVal<int>("ResourceId"));
+  MatQuery mq(m);
+  EXPECT_LT(mq.mass(id("pu241")), 1.0 / 101);
+  EXPECT_GT(mq.mass(id("am241")), 0);
+}
+
+// Assemblies received and discharged together are stored as a single lot -
+// check that they are still traded away as separate assemblies.
+TEST(ReactorTests, AssemblyLots) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>2</assem_size>  "
+     "  <n_assem_core>3</n_assem_core>  "
+     "  <n_assem_batch>3</n_assem_batch>  ";
+
+  int simdur = 3;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddSink("waste").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int aid = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("SenderId", "==", aid));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  // a batch discharged on time steps 1 and 2
+  ASSERT_EQ(6, qr.rows.size());
+  std::set<int> ids;
+  for (int i = 0; i < qr.rows.size(); i++) {
+    int resid = qr.GetVal<int>("ResourceId", i);
+    ids.insert(resid);
+    EXPECT_DOUBLE_EQ(2, sim.GetMaterial(resid)->quantity());
+  }
+  EXPECT_EQ(6, ids.size());
+}
+
+// The assemblies of the initial core are discharged after 1, 2 and 3 cycles
+// in the core and every later one after 3 - their compositions are
+// interpolated from the burnup table.
+TEST(ReactorTests, BurnupTable) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>3</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     ""
+     "  <burnup_commods> <val>uox</val>    <val>uox</val>    </burnup_commods>"
+     "  <burnup_cycles>  <val>1</val>      <val>3</val>      </burnup_cycles>"
+     "  <burnup_recipes> <val>spent1</val> <val>spent3</val> </burnup_recipes>";
+
+  int simdur = 5;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddSink("waste").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  cyclus::CompMap v;
+  v[id("u238")] = 99;
+  v[id("pu239")] = 1;
+  sim.AddRecipe("spent1", Composition::CreateFromMass(v));
+  v[id("u238")] = 97;
+  v[id("pu239")] = 3;
+  sim.AddRecipe("spent3", Composition::CreateFromMass(v));
+  int aid = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("SenderId", "==", aid));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  ASSERT_EQ(4, qr.rows.size());
+  std::map<int, double> pu;
+  for (int i = 0; i < qr.rows.size(); i++) {
+    MatQuery mq(sim.GetMaterial(qr.GetVal<int>("ResourceId", i)));
+    pu[qr.GetVal<int>("Time", i)] = mq.mass(id("pu239"));
+  }
+  EXPECT_NEAR(0.01, pu[1], 1e-9);
+  EXPECT_NEAR(0.02, pu[2], 1e-9);
+  EXPECT_NEAR(0.03, pu[3], 1e-9);
+  EXPECT_NEAR(0.03, pu[4], 1e-9);
+}
+
 // tests that spent fuel is offerred on correct commods according to the
 // incommod it was received on - esp when dealing with multiple fuel commods
 // simultaneously.
@@ -461,6 +635,459 @@ TEST(ReactorTests, RecipeChange) {
   EXPECT_TRUE(0 < mq.mass(id("H1")));
 }
 
+// Mid-cycle reactors skip most of their Tick/Tock work until their next
+// event - check that cycle boundaries, power and a recipe change scheduled
+// in the middle of a cycle all still happen on time.
+TEST(ReactorTests, LongCycle) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>lwr_fresh</val>  </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>lwr_spent</val>  </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>enriched_u</val> </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>      </fuel_outcommods>  "
+     ""
+     "  <cycle_time>10</cycle_time>  "
+     "  <refuel_time>2</refuel_time>  "
+     "  <assem_size>300</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <power_cap>100</power_cap>  "
+     ""
+     "  <recipe_change_times>   <val>5</val>          </recipe_change_times>"
+     "  <recipe_change_commods> <val>enriched_u</val> </recipe_change_commods>"
+     "  <recipe_change_in>      <val>water</val>      </recipe_change_in>"
+     "  <recipe_change_out>     <val>water</val>      </recipe_change_out>";
+
+  int simdur = 30;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("enriched_u").Finalize();
+  sim.AddSink("waste").Finalize();
+  sim.AddRecipe("lwr_fresh", c_uox());
+  sim.AddRecipe("lwr_spent", c_spentuox());
+  sim.AddRecipe("water", c_water());
+  int aid = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", aid));
+  QueryResult qr = sim.db().Query("TimeSeriesPower", &conds);
+  ASSERT_EQ(simdur, qr.rows.size());
+  for (int i = 0; i < qr.rows.size(); i++) {
+    int t = qr.GetVal<int>("Time", i);
+    // cycles start at 0, 12 and 24 with two refueling steps between
+    double want = (t % 12) < 10 ? 100 : 0;
+    EXPECT_DOUBLE_EQ(want, qr.GetVal<double>("Value", i)) << "t=" << t;
+  }
+
+  // the first batch was burned to the changed outrecipe
+  conds.clear();
+  conds.push_back(Cond("Time", "==", 10));
+  conds.push_back(Cond("SenderId", "==", aid));
+  qr = sim.db().Query("Transactions", &conds);
+  MatQuery mq = MatQuery(sim.GetMaterial(qr.GetVal<int>("ResourceId")));
+  EXPECT_TRUE(0 < mq.mass(id("H1")));
+
+  conds.clear();
+  conds.push_back(Cond("Time", "==", 22));
+  conds.push_back(Cond("SenderId", "==", aid));
+  qr = sim.db().Query("Transactions", &conds);
+  EXPECT_EQ(1, qr.rows.size());
+}
+
+TEST(ReactorTests, PowerIntervals) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>lwr_fresh</val>  </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>lwr_spent</val>  </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>enriched_u</val> </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>      </fuel_outcommods>  "
+     ""
+     "  <cycle_time>3</cycle_time>  "
+     "  <refuel_time>1</refuel_time>  "
+     "  <assem_size>300</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <power_cap>100</power_cap>  "
+     "  <power_intervals>1</power_intervals>  ";
+
+  int simdur = 10;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("enriched_u").Finalize();
+  sim.AddSink("waste").Finalize();
+  sim.AddRecipe("lwr_fresh", c_uox());
+  sim.AddRecipe("lwr_spent", c_spentuox());
+  int aid = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", aid));
+  QueryResult qr = sim.db().Query("PowerIntervals", &conds);
+  // operating 0-2, 4-6 and 8-9 with refueling in between
+  int start[] = {0, 3, 4, 7, 8};
+  int end[] = {2, 3, 6, 7, 9};
+  double val[] = {100, 0, 100, 0, 100};
+  ASSERT_EQ(5, qr.rows.size());
+  for (int i = 0; i < qr.rows.size(); i++) {
+    EXPECT_EQ(start[i], qr.GetVal<int>("Start", i));
+    EXPECT_EQ(end[i], qr.GetVal<int>("End", i));
+    EXPECT_DOUBLE_EQ(val[i], qr.GetVal<double>("Value", i));
+  }
+
+  // nothing per time step
+  EXPECT_THROW(sim.db().Query("TimeSeriesPower", &conds), std::exception);
+}
+
+// A scheduled outage produces no power and lengthens the cycle it falls in.
+TEST(ReactorTests, ScheduledOutage) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>lwr_fresh</val>  </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>lwr_spent</val>  </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>enriched_u</val> </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>      </fuel_outcommods>  "
+     ""
+     "  <cycle_time>3</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>300</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <power_cap>100</power_cap>  "
+     ""
+     "  <outage_starts>  <val>1</val> </outage_starts>  "
+     "  <outage_lengths> <val>2</val> </outage_lengths>  ";
+
+  int simdur = 8;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("enriched_u").Finalize();
+  sim.AddSink("waste").Finalize();
+  sim.AddRecipe("lwr_fresh", c_uox());
+  sim.AddRecipe("lwr_spent", c_spentuox());
+  int aid = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", aid));
+  QueryResult qr = sim.db().Query("TimeSeriesPower", &conds);
+  ASSERT_EQ(simdur, qr.rows.size());
+  double want[] = {100, 0, 0, 100, 100, 100, 100, 100};
+  for (int i = 0; i < qr.rows.size(); i++) {
+    int t = qr.GetVal<int>("Time", i);
+    EXPECT_DOUBLE_EQ(want[t], qr.GetVal<double>("Value", i)) << "t=" << t;
+  }
+
+  // the first cycle ends two time steps late
+  conds.push_back(Cond("Event", "==", std::string("CYCLE_END")));
+  qr = sim.db().Query("ReactorEvents", &conds);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ(5, qr.GetVal<int>("Time"));
+}
+
+// Outages of negative length are rejected.
+TEST(ReactorTests, NegativeOutage) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>lwr_fresh</val>  </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>lwr_spent</val>  </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>enriched_u</val> </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>      </fuel_outcommods>  "
+     ""
+     "  <cycle_time>3</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>300</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     ""
+     "  <outage_starts>  <val>1</val>  </outage_starts>  "
+     "  <outage_lengths> <val>-2</val> </outage_lengths>  ";
+
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, 4);
+  sim.AddRecipe("lwr_fresh", c_uox());
+  sim.AddRecipe("lwr_spent", c_spentuox());
+  EXPECT_THROW(sim.Run(), cyclus::ValueError);
+}
+
+// Random outages take the reactor down on about the expected share of time
+// steps.
+TEST(ReactorTests, Availability) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>lwr_fresh</val>  </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>lwr_spent</val>  </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>enriched_u</val> </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>      </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1000</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>300</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <power_cap>100</power_cap>  "
+     "  <availability>0.8</availability>  "
+     "  <availability_seed>7</availability_seed>  ";
+
+  int simdur = 500;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("enriched_u").Finalize();
+  sim.AddRecipe("lwr_fresh", c_uox());
+  sim.AddRecipe("lwr_spent", c_spentuox());
+  int aid = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", aid));
+  QueryResult qr = sim.db().Query("TimeSeriesPower", &conds);
+  ASSERT_EQ(simdur, qr.rows.size());
+  int up = 0;
+  for (int i = 0; i < qr.rows.size(); i++) {
+    up += qr.GetVal<double>("Value", i) > 0;
+  }
+  EXPECT_NEAR(0.8, double(up) / simdur, 0.06);
+}
+
+double request_pref(Reactor* r) {
+  std::set<cyclus::RequestPortfolio<Material>::Ptr> ports =
+      r->GetMatlRequests();
+  if (ports.empty() || (*ports.begin())->requests().empty()) {
+    return -100;
+  }
+  return (*ports.begin())->requests()[0]->preference();
+}
+
+// The fuel configuration is shared with the prototype - check that a pref
+// change only affects the reactor it fires on.
+TEST(ReactorTests, PrefChangeNotShared) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>lwr_fresh</val>  </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>lwr_spent</val>  </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>enriched_u</val> </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>      </fuel_outcommods>  "
+     "  <fuel_prefs>      <val>1</val>          </fuel_prefs>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>300</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     ""
+     "  <pref_change_times>   <val>1</val>          </pref_change_times>"
+     "  <pref_change_commods> <val>enriched_u</val> </pref_change_commods>"
+     "  <pref_change_values>  <val>7</val>          </pref_change_values>";
+
+  // no fuel source - the core stays empty and fuel is requested every step
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, 3);
+  sim.AddRecipe("lwr_fresh", c_uox());
+  sim.AddRecipe("lwr_spent", c_spentuox());
+  sim.Run();
+
+  Reactor* r = dynamic_cast<Reactor*>(sim.agent);
+  ASSERT_TRUE(r != NULL);
+  EXPECT_DOUBLE_EQ(7, request_pref(r));
+
+  Reactor* clone = r->context()->CreateAgent<Reactor>(r->prototype());
+  EXPECT_DOUBLE_EQ(1, request_pref(clone));
+  r->context()->DelAgent(clone);
+}
+
+// A clone produces power at the capacity of its prototype.
+TEST(ReactorTests, ClonePower) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>lwr_fresh</val>  </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>lwr_spent</val>  </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>enriched_u</val> </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>      </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>300</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <power_cap>100</power_cap>  ";
+
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, 1);
+  sim.AddRecipe("lwr_fresh", c_uox());
+  sim.AddRecipe("lwr_spent", c_spentuox());
+  sim.Run();
+
+  Reactor* r = dynamic_cast<Reactor*>(sim.agent);
+  ASSERT_TRUE(r != NULL);
+  Reactor* clone = r->context()->CreateAgent<Reactor>(r->prototype());
+  cyclus::toolkit::Commodity power("power");
+  ASSERT_TRUE(clone->Produces(power));
+  EXPECT_DOUBLE_EQ(100, clone->Capacity(power));
+  EXPECT_EQ(1, clone->ProducedCommodities().size());
+  r->context()->DelAgent(clone);
+}
+
+// Bidding must treat the request map shared by all bidders as read-only -
+// in particular, it must not add entries for its own outcommods.
+TEST(ReactorTests, BidsLeaveRequestsUnchanged) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>lwr_fresh</val>  </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>lwr_spent</val>  </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>enriched_u</val> </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>      </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>300</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  ";
+
+  // no sink - spent fuel piles up
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, 3);
+  sim.AddSource("enriched_u").Finalize();
+  sim.AddRecipe("lwr_fresh", c_uox());
+  sim.AddRecipe("lwr_spent", c_spentuox());
+  sim.Run();
+  Reactor* r = dynamic_cast<Reactor*>(sim.agent);
+  ASSERT_TRUE(r != NULL);
+
+  Material::Ptr target = Material::CreateUntracked(300, c_uox());
+  cyclus::Request<Material>* req =
+      cyclus::Request<Material>::Create(target, r, "other");
+  cyclus::CommodMap<Material>::type reqs;
+  reqs["other"].push_back(req);
+
+  EXPECT_TRUE(r->GetMatlBids(reqs).empty());
+  ASSERT_EQ(1, reqs.size());
+  EXPECT_EQ(1, reqs["other"].size());
+  EXPECT_EQ(0, reqs.count("waste"));
+
+  // and with requests for its spent fuel
+  reqs["waste"].push_back(
+      cyclus::Request<Material>::Create(target, r, "waste"));
+  EXPECT_EQ(1, r->GetMatlBids(reqs).size());
+  EXPECT_EQ(2, reqs.size());
+  EXPECT_EQ(1, reqs["waste"].size());
+}
+
+TEST(ReactorTests, BidAllocs) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  ";
+
+  // no sink - a spent lot piles up every time step
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, 5);
+  sim.AddSource("uox").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  sim.Run();
+  Reactor* r = dynamic_cast<Reactor*>(sim.agent);
+  ASSERT_TRUE(r != NULL);
+  long nlots = r->SnapshotInv()["spent"].size();
+  ASSERT_GT(nlots, 1);
+
+  // each request is bid on with a single assembly
+  int nreqs = 4;
+  Material::Ptr target = Material::CreateUntracked(1, c_uox());
+  cyclus::CommodMap<Material>::type reqs;
+  for (int i = 0; i < nreqs; i++) {
+    reqs["waste"].push_back(
+        cyclus::Request<Material>::Create(target, r, "waste"));
+  }
+
+  // per call: the map of spent lots by commodity and its node (1), the copy
+  // of the lots bid on (1), the portfolio and its count (2), the capacity
+  // constraint's converter and its count and set node (3), the portfolio's
+  // set node and the copy of the returned set (2) - plus a margin of 2
+  const long call_budget = 11;
+  // per spent lot: peeking at the spent buffer (its entries in the popped
+  // vector, the buffer's list and the buffer's set), its entry in the map of
+  // lots by commodity and in the list of offers (5) - the offers are pooled
+  // from the first call
+  const long lot_budget = 5;
+  // per request: the bid and its set node in the portfolio
+  const long req_budget = 2;
+
+  std::set<cyclus::BidPortfolio<Material>::Ptr> ports = r->GetMatlBids(reqs);
+  ports.clear();
+
+  EXPECT_ALLOCS_LE(call_budget + nlots * lot_budget + nreqs * req_budget,
+                   ports = r->GetMatlBids(reqs));
+  ASSERT_EQ(1, ports.size());
+  EXPECT_EQ(nreqs, (*ports.begin())->bids().size());
+}
+
+// Bids of many reactors made on a pool of threads at once must be the same
+// as those made one reactor at a time - including the decayed compositions
+// shared through the decay cache.
+TEST(ReactorTests, ParallelBids) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <decay_spent>1</decay_spent>  ";
+
+  // no sink - spent fuel discharged at different times piles up
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, 8);
+  sim.AddSource("uox").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  cyclus::CompMap v;
+  v[id("u238")] = 100;
+  v[id("pu241")] = 1;
+  sim.AddRecipe("spentuox", Composition::CreateFromMass(v));
+  sim.Run();
+  Reactor* r = dynamic_cast<Reactor*>(sim.agent);
+  ASSERT_TRUE(r != NULL);
+  std::vector<cyclus::Resource::Ptr> spent = r->SnapshotInv()["spent"];
+  ASSERT_GT(spent.size(), 1);
+
+  // two identical sets of reactors holding differing amounts of the spent
+  // fuel - one bid for in parallel and one serially
+  int n = 400;
+  std::vector<Reactor*> par;
+  std::vector<Reactor*> ser;
+  for (int i = 0; i < n; i++) {
+    cyclus::Inventories invs;
+    invs["spent"].assign(spent.begin(),
+                         spent.begin() + 1 + i % spent.size());
+    Reactor* a = r->context()->CreateAgent<Reactor>(r->prototype());
+    a->InitInv(invs);
+    par.push_back(a);
+    Reactor* b = r->context()->CreateAgent<Reactor>(r->prototype());
+    b->InitInv(invs);
+    ser.push_back(b);
+  }
+
+  cyclus::CommodMap<Material>::type reqs;
+  for (int i = 1; i <= 3; i++) {
+    Material::Ptr target = Material::CreateUntracked(i, c_uox());
+    reqs["waste"].push_back(
+        cyclus::Request<Material>::Create(target, r, "waste"));
+  }
+
+  DecayCache::Instance(r->context())->Clear();
+  std::vector<BidSet> par_bids = BidInParallel(par, reqs, 8);
+
+  for (int i = 0; i < n; i++) {
+    BidSet ser_bids = ser[i]->GetMatlBids(reqs);
+    ASSERT_EQ(ser_bids.size(), par_bids[i].size()) << "reactor " << i;
+    EXPECT_EQ(DescribeBids(ser_bids), DescribeBids(par_bids[i]))
+        << "reactor " << i;
+  }
+  EXPECT_EQ(1, reqs.size());
+  EXPECT_EQ(3, reqs["waste"].size());
+}
+
+TEST(ReactorTests, RunLength) {
+  std::vector<int> vals;
+  EXPECT_TRUE(RunLengthEncode(vals).empty());
+  EXPECT_TRUE(RunLengthDecode(RunLengthEncode(vals)).empty());
+
+  int v[] = {1, 1, 1, 0, 0, 1, 2, 2, 2, 2};
+  vals.assign(v, v + 10);
+  std::vector<int> runs = RunLengthEncode(vals);
+  int want[] = {3, 1, 2, 0, 1, 1, 4, 2};
+  EXPECT_EQ(std::vector<int>(want, want + 8), runs);
+  EXPECT_EQ(vals, RunLengthDecode(runs));
+}
+
 } // namespace reactortests
 } // namespace cycamore
 
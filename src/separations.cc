@@ -0,0 +1,349 @@
+#include "separations.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include "comp_interner.h"
+#include "instrument.h"
+
+using cyclus::Material;
+using cyclus::Composition;
+using cyclus::toolkit::ResBuf;
+
+namespace cycamore {
+
+namespace {
+
+// one past the largest atomic number
+const int kNElem = 119;
+
+}  // namespace
+
+Separations::Separations(cyclus::Context* ctx)
+    : cyclus::Facility(ctx),
+      feedbuf_size(std::numeric_limits<double>::max()),
+      throughput(std::numeric_limits<double>::max()),
+      leftoverbuf_size(std::numeric_limits<double>::max()) {}
+
+#pragma cyclus def clone cycamore::Separations
+
+#pragma cyclus def schema cycamore::Separations
+
+#pragma cyclus def annotations cycamore::Separations
+
+#pragma cyclus def infiletodb cycamore::Separations
+
+#pragma cyclus def snapshot cycamore::Separations
+
+#pragma cyclus def initfromcopy cycamore::Separations
+
+#pragma cyclus def initfromdb cycamore::Separations
+
+cyclus::Inventories Separations::SnapshotInv() {
+  cyclus::Inventories invs;
+  invs["feed"] = feed_.PopNRes(feed_.count());
+  feed_.Push(invs["feed"]);
+  invs["leftover"] = leftover_.PopNRes(leftover_.count());
+  leftover_.Push(invs["leftover"]);
+  for (int i = 0; i < streambufs_.size(); i++) {
+    std::vector<cyclus::Resource::Ptr>& inv = invs["stream " + streams[i]];
+    inv = streambufs_[i].PopNRes(streambufs_[i].count());
+    streambufs_[i].Push(inv);
+  }
+  return invs;
+}
+
+void Separations::InitInv(cyclus::Inventories& inv) {
+  // restarted agents skip EnterNotify - the table is not a state variable
+  BuildTable();
+  Allocate();
+  feed_.Push(inv["feed"]);
+  leftover_.Push(inv["leftover"]);
+  for (int i = 0; i < streambufs_.size(); i++) {
+    streambufs_[i].Push(inv["stream " + streams[i]]);
+  }
+}
+
+std::string Separations::str() {
+  std::stringstream ss;
+  ss << cyclus::Facility::str() << " separates " << feed_.quantity()
+     << " kg of feed into";
+  for (int i = 0; i < streams.size(); i++) {
+    ss << " '" << streams[i] << "'";
+  }
+  ss << " and '" << leftover_commod << "'";
+  return ss.str();
+}
+
+void Separations::EnterNotify() {
+  cyclus::Facility::EnterNotify();
+  BuildTable();
+  Allocate();
+}
+
+void Separations::Allocate() {
+  feed_.capacity(feedbuf_size);
+  leftover_.capacity(leftoverbuf_size);
+  streambufs_.resize(streams.size());
+  for (int i = 0; i < stream_caps.size() && i < streambufs_.size(); i++) {
+    streambufs_[i].capacity(stream_caps[i]);
+  }
+}
+
+void Separations::BuildTable() {
+  int n = eff_streams.size();
+  std::stringstream ss;
+  if (eff_elems.size() != n) {
+    ss << "prototype '" << prototype() << "' has " << eff_elems.size()
+       << " eff_elems vals, expected " << n << "\n";
+  }
+  if (eff_values.size() != n) {
+    ss << "prototype '" << prototype() << "' has " << eff_values.size()
+       << " eff_values vals, expected " << n << "\n";
+  }
+  if (!stream_caps.empty() && stream_caps.size() != streams.size()) {
+    ss << "prototype '" << prototype() << "' has " << stream_caps.size()
+       << " stream_caps vals, expected " << streams.size() << "\n";
+  }
+  if (ss.str().size() > 0) {
+    throw cyclus::ValueError(ss.str());
+  }
+
+  int n_streams = streams.size();
+  eff_.assign(kNElem * n_streams, 0);
+  for (int i = 0; i < n; i++) {
+    int s = std::find(streams.begin(), streams.end(), eff_streams[i]) -
+            streams.begin();
+    if (s == n_streams) {
+      ss << "prototype '" << prototype() << "' has efficiencies for '"
+         << eff_streams[i] << "', which is not one of its streams\n";
+      continue;
+    }
+    int z = pyne::nucname::znum(pyne::nucname::id(eff_elems[i]));
+    if (eff_values[i] < 0 || eff_values[i] > 1) {
+      ss << "prototype '" << prototype() << "' has efficiency "
+         << eff_values[i] << " for " << eff_elems[i] << " in '"
+         << eff_streams[i] << "', expected 0 to 1\n";
+    }
+    eff_[z * n_streams + s] = eff_values[i];
+  }
+
+  for (int z = 0; z < kNElem; z++) {
+    double tot = 0;
+    for (int s = 0; s < n_streams; s++) {
+      tot += eff_[z * n_streams + s];
+    }
+    if (tot > 1 + cyclus::eps()) {
+      ss << "prototype '" << prototype() << "' has efficiencies summing to "
+         << tot << " for element " << z << ", expected at most 1\n";
+    }
+  }
+  if (ss.str().size() > 0) {
+    throw cyclus::ValueError(ss.str());
+  }
+  split_comp_.reset();
+}
+
+void Separations::Split(Composition::Ptr c) {
+  if (c == split_comp_) {
+    return;
+  }
+  int n_streams = streams.size();
+  std::vector<cyclus::CompMap> out(n_streams);
+  split_fracs_.assign(n_streams, 0);
+
+  // one pass over the nuclides - each one goes to the streams at the
+  // efficiencies of its element's row of the table.  Compositions are not
+  // normalized (e.g. absorbed feed is in kg), so the fractions are taken
+  // from a normalized copy.
+  cyclus::CompMap v = c->mass();
+  cyclus::compmath::Normalize(&v, 1);
+  cyclus::CompMap::const_iterator it;
+  for (it = v.begin(); it != v.end(); ++it) {
+    const double* row = &eff_[pyne::nucname::znum(it->first) * n_streams];
+    for (int s = 0; s < n_streams; s++) {
+      if (row[s] > 0) {
+        double q = it->second * row[s];
+        out[s][it->first] = q;
+        split_fracs_[s] += q;
+      }
+    }
+  }
+
+  CompInterner* interner = CompInterner::Instance(context());
+  split_comps_.resize(n_streams);
+  for (int s = 0; s < n_streams; s++) {
+    split_comps_[s].reset();
+    if (split_fracs_[s] > 0) {
+      split_comps_[s] = interner->Mass(out[s]);
+    }
+  }
+  split_comp_ = c;
+}
+
+void Separations::Tock() {
+  CYCAMORE_TIME("Tock");
+  if (feed_.count() == 0) {
+    return;
+  }
+
+  Split(feed_.Peek()->comp());
+
+  // separate as much feed as the throughput and the room in every buffer
+  // allow
+  double qty = std::min(throughput, feed_.quantity());
+  double left = 1;
+  for (int s = 0; s < streambufs_.size(); s++) {
+    if (split_fracs_[s] > 0) {
+      qty = std::min(qty, streambufs_[s].space() / split_fracs_[s]);
+    }
+    left -= split_fracs_[s];
+  }
+  if (left > cyclus::eps()) {
+    qty = std::min(qty, leftover_.space() / left);
+  }
+  if (qty < cyclus::eps()) {
+    return;
+  }
+
+  Material::Ptr m;
+  if (cyclus::AlmostEq(qty, feed_.quantity())) {
+    m = feed_.Pop();
+  } else {
+    m = feed_.Pop(qty);
+  }
+  double total = m->quantity();
+  for (int s = 0; s < streambufs_.size(); s++) {
+    double amt = std::min(split_fracs_[s] * total, m->quantity());
+    if (amt > cyclus::eps()) {
+      streambufs_[s].Push(m->ExtractComp(amt, split_comps_[s]));
+    }
+  }
+  if (m->quantity() > 0) {
+    leftover_.Push(m);
+  }
+}
+
+std::set<cyclus::RequestPortfolio<Material>::Ptr>
+Separations::GetMatlRequests() {
+  CYCAMORE_TIME("GetMatlRequests");
+  using cyclus::RequestPortfolio;
+  using cyclus::Request;
+
+  std::set<RequestPortfolio<Material>::Ptr> ports;
+  double amt = feed_.space();
+  if (amt < cyclus::eps()) {
+    return ports;
+  }
+
+  Material::Ptr m;
+  if (feed_recipe.empty()) {
+    m = cyclus::NewBlankMaterial(amt);
+  } else {
+    targets_.Reset(context()->time());
+    m = targets_.Get(amt, context()->GetRecipe(feed_recipe));
+  }
+
+  RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
+  std::vector<Request<Material>*> mutuals;
+  for (int i = 0; i < feed_commods.size(); i++) {
+    mutuals.push_back(port->AddRequest(m, this, feed_commods[i]));
+  }
+  port->AddMutualReqs(mutuals);
+  ports.insert(port);
+  CYCAMORE_COUNT_REQUESTS(ports);
+  return ports;
+}
+
+void Separations::AcceptMatlTrades(const std::vector<std::pair<
+    cyclus::Trade<Material>, Material::Ptr> >& responses) {
+  CYCAMORE_TIME("AcceptMatlTrades");
+  if (responses.empty()) {
+    return;
+  }
+  // compact the feed into a single material
+  std::vector<Material::Ptr> mats = feed_.PopN(feed_.count());
+  for (int i = 0; i < responses.size(); i++) {
+    mats.push_back(responses[i].second);
+  }
+  feed_.Push(cyclus::toolkit::Squash(mats));
+}
+
+std::set<cyclus::BidPortfolio<Material>::Ptr> Separations::GetMatlBids(
+    cyclus::CommodMap<Material>::type& commod_requests) {
+  CYCAMORE_TIME("GetMatlBids");
+  std::set<cyclus::BidPortfolio<Material>::Ptr> ports;
+  offers_.Reset(context()->time());
+  cyclus::CommodMap<Material>::type::const_iterator found;
+  for (int i = 0; i < streams.size(); i++) {
+    found = commod_requests.find(streams[i]);
+    if (found != commod_requests.end() &&
+        streambufs_[i].quantity() > cyclus::eps()) {
+      ports.insert(BidOn(&streambufs_[i], found->second));
+    }
+  }
+  found = commod_requests.find(leftover_commod);
+  if (found != commod_requests.end() &&
+      leftover_.quantity() > cyclus::eps()) {
+    ports.insert(BidOn(&leftover_, found->second));
+  }
+  CYCAMORE_COUNT_BIDS(ports);
+  return ports;
+}
+
+cyclus::BidPortfolio<Material>::Ptr Separations::BidOn(
+    ResBuf<Material>* buf,
+    const std::vector<cyclus::Request<Material>*>& reqs) {
+  using cyclus::BidPortfolio;
+  using cyclus::CapacityConstraint;
+
+  double avail = buf->quantity();
+  // the composition of what would be traded away first - see the class doc
+  Composition::Ptr c = buf->Peek()->comp();
+  BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
+  for (int i = 0; i < reqs.size(); i++) {
+    double qty = std::min(reqs[i]->target()->quantity(), avail);
+    port->AddBid(reqs[i], offers_.Get(qty, c), this);
+  }
+  CapacityConstraint<Material> cc(avail);
+  port->AddConstraint(cc);
+  return port;
+}
+
+ResBuf<Material>* Separations::Buffer(const std::string& commod) {
+  for (int i = 0; i < streams.size(); i++) {
+    if (streams[i] == commod) {
+      return &streambufs_[i];
+    }
+  }
+  if (commod == leftover_commod) {
+    return &leftover_;
+  }
+  return NULL;
+}
+
+void Separations::GetMatlTrades(
+    const std::vector<cyclus::Trade<Material> >& trades,
+    std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
+        responses) {
+  CYCAMORE_TIME("GetMatlTrades");
+  for (int i = 0; i < trades.size(); i++) {
+    ResBuf<Material>* buf = Buffer(trades[i].request->commodity());
+    double qty = trades[i].amt;
+    Material::Ptr m;
+    // required so popping doesn't fail on round off
+    if (cyclus::AlmostEq(qty, buf->quantity())) {
+      m = cyclus::toolkit::Squash(buf->PopN(buf->count()));
+    } else {
+      m = buf->Pop(qty);
+    }
+    responses.push_back(std::make_pair(trades[i], m));
+  }
+}
+
+extern "C" cyclus::Agent* ConstructSeparations(cyclus::Context* ctx) {
+  return new Separations(ctx);
+}
+
+}  // namespace cycamore
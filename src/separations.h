@@ -0,0 +1,187 @@
+#ifndef CYCAMORE_SRC_SEPARATIONS_H_
+#define CYCAMORE_SRC_SEPARATIONS_H_
+
+#include <string>
+#include <vector>
+
+#include "cyclus.h"
+#include "untracked_pool.h"
+
+namespace cycamore {
+
+/// Separations splits the material it receives into output streams by
+/// element.  Each stream takes a fraction - its efficiency - of every element
+/// of the feed, and what no stream takes is leftover waste.
+///
+/// The efficiencies are expanded into a dense table indexed by element and
+/// stream when the facility is deployed, so a batch of feed is split in a
+/// single pass over its nuclides.  The split of a feed composition is kept
+/// until the feed composition changes.  Received feed is absorbed into a
+/// single feed material on arrival, so each time step splits one material
+/// no matter how many batches were received.
+///
+/// Up to throughput kg of feed are separated each time step - less if a
+/// stream or the leftover buffer would overflow.  Separated streams and the
+/// leftover are offered on their commodities as aggregates of their buffers.
+/// Each offer carries the composition of the oldest material in its buffer
+/// only: a buffer holding output of several time steps with different feed
+/// compositions is offered as if it were all like the oldest of them.
+class Separations : public cyclus::Facility {
+#pragma cyclus note { \
+"niche": "separations", \
+"doc": \
+  "Separations splits the material it receives into output streams by" \
+  " element.  Each stream takes a fraction - its efficiency - of every" \
+  " element of the feed, and what no stream takes is leftover waste." \
+  "  Up to throughput kg of feed are separated each time step - less if a" \
+  " stream or the leftover buffer would overflow.  Separated streams and the" \
+  " leftover are offered on their commodities.  Each offer carries the" \
+  " composition of the oldest material in its buffer only, even when the" \
+  " buffer holds output of different feed compositions.", \
+}
+
+ public:
+  Separations(cyclus::Context* ctx);
+  virtual ~Separations() {};
+
+  virtual std::string str();
+
+  virtual void EnterNotify();
+  virtual void Tick() {};
+  virtual void Tock();
+
+  virtual void AcceptMatlTrades(const std::vector<std::pair<
+      cyclus::Trade<cyclus::Material>, cyclus::Material::Ptr> >& responses);
+
+  virtual std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>
+  GetMatlRequests();
+
+  virtual std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> GetMatlBids(
+      cyclus::CommodMap<cyclus::Material>::type& commod_requests);
+
+  virtual void GetMatlTrades(
+      const std::vector<cyclus::Trade<cyclus::Material> >& trades,
+      std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                            cyclus::Material::Ptr> >& responses);
+
+  #pragma cyclus decl
+
+ private:
+  /// Sizes the stream buffers and sets the capacities of all buffers.
+  void Allocate();
+
+  /// Builds the dense efficiency table from the efficiency parameters.
+  /// @throws cyclus::ValueError if they are inconsistent
+  void BuildTable();
+
+  /// Computes the fraction of feed of composition c going to each stream and
+  /// the composition of each stream - unless c was the last one split.
+  void Split(cyclus::Composition::Ptr c);
+
+  /// Returns the buffer offered on commod, or NULL if there is none.
+  cyclus::toolkit::ResBuf<cyclus::Material>* Buffer(const std::string& commod);
+
+  /// Makes a bid portfolio offering the aggregate of buf to reqs.
+  cyclus::BidPortfolio<cyclus::Material>::Ptr BidOn(
+      cyclus::toolkit::ResBuf<cyclus::Material>* buf,
+      const std::vector<cyclus::Request<cyclus::Material>*>& reqs);
+
+  #pragma cyclus var { \
+    "uitype": ["oneormore", "incommodity"], \
+    "doc": "Commodities on which to request feed material.", \
+  }
+  std::vector<std::string> feed_commods;
+
+  #pragma cyclus var { \
+    "default": "", \
+    "uitype": "recipe", \
+    "doc": "Recipe of the feed material to request, where the default (empty" \
+           " string) is to accept everything.", \
+  }
+  std::string feed_recipe;
+
+  #pragma cyclus var { \
+    "default": 1e299, \
+    "doc": "Maximum amount of feed material to keep on hand.", \
+    "units": "kg", \
+  }
+  double feedbuf_size;
+
+  #pragma cyclus var { \
+    "default": 1e299, \
+    "doc": "Maximum amount of feed material separated per time step.", \
+    "units": "kg/(time step)", \
+  }
+  double throughput;
+
+  #pragma cyclus var { \
+    "uitype": ["oneormore", "outcommodity"], \
+    "doc": "Commodities on which to offer each of the separated streams.", \
+  }
+  std::vector<std::string> streams;
+
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "Maximum amount of separated material to keep on hand for each" \
+           " stream (same order).  If none are given, the buffers of all" \
+           " streams are unlimited (default).", \
+    "units": "kg", \
+  }
+  std::vector<double> stream_caps;
+
+  #pragma cyclus var { \
+    "uitype": ["oneormore", "outcommodity"], \
+    "doc": "The stream of a separation efficiency.", \
+  }
+  std::vector<std::string> eff_streams;
+
+  #pragma cyclus var { \
+    "doc": "The element (e.g. 'Pu') of a separation efficiency." \
+           " Same order as and direct correspondence to the efficiency streams.", \
+  }
+  std::vector<std::string> eff_elems;
+
+  #pragma cyclus var { \
+    "doc": "The fraction of the element going to the stream of a separation" \
+           " efficiency.  Same order as and direct correspondence to the" \
+           " efficiency streams.  The efficiencies of an element must not sum" \
+           " to more than 1.", \
+  }
+  std::vector<double> eff_values;
+
+  #pragma cyclus var { \
+    "uitype": "outcommodity", \
+    "doc": "Commodity on which to offer the leftover material no stream takes.", \
+  }
+  std::string leftover_commod;
+
+  #pragma cyclus var { \
+    "default": 1e299, \
+    "doc": "Maximum amount of leftover material to keep on hand.", \
+    "units": "kg", \
+  }
+  double leftoverbuf_size;
+
+  /// the feed - a single material
+  cyclus::toolkit::ResBuf<cyclus::Material> feed_;
+  /// separated material of each stream (same order as streams)
+  std::vector<cyclus::toolkit::ResBuf<cyclus::Material> > streambufs_;
+  cyclus::toolkit::ResBuf<cyclus::Material> leftover_;
+
+  /// efficiency of stream s for element z at eff_[z * streams.size() + s]
+  std::vector<double> eff_;
+
+  /// the last composition split, the fraction of it going to each stream
+  /// and the composition of each stream
+  cyclus::Composition::Ptr split_comp_;
+  std::vector<double> split_fracs_;
+  std::vector<cyclus::Composition::Ptr> split_comps_;
+
+  /// request targets and bid offers
+  UntrackedPool targets_;
+  UntrackedPool offers_;
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_SEPARATIONS_H_
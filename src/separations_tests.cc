@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+
+#include "cyclus.h"
+#include "parallel_bids.h"
+#include "separations.h"
+
+using cyclus::Composition;
+using cyclus::Cond;
+using cyclus::Material;
+using cyclus::QueryResult;
+using cyclus::toolkit::MatQuery;
+using pyne::nucname::id;
+
+namespace cycamore {
+namespace separationstests {
+
+Composition::Ptr c_spent() {
+  cyclus::CompMap m;
+  m[id("u235")] = .8;
+  m[id("u238")] = 100;
+  m[id("pu239")] = 1;
+  return Composition::CreateFromMass(m);
+};
+
+const std::string effs =
+    "  <feed_commods> <val>spent</val> </feed_commods>  "
+    "  <streams> <val>pu</val> <val>u</val> </streams>  "
+    "  <eff_streams> <val>pu</val> <val>u</val> </eff_streams>  "
+    "  <eff_elems>   <val>Pu</val> <val>U</val> </eff_elems>  "
+    "  <eff_values>  <val>0.99</val> <val>0.5</val> </eff_values>  "
+    "  <leftover_commod>waste</leftover_commod>  ";
+
+Composition::Ptr c_depleted() {
+  cyclus::CompMap m;
+  m[id("u238")] = 100;
+  return Composition::CreateFromMass(m);
+};
+
+double total(const std::vector<cyclus::Resource::Ptr>& inv) {
+  double tot = 0;
+  for (int i = 0; i < inv.size(); i++) {
+    tot += inv[i]->quantity();
+  }
+  return tot;
+}
+
+double traded(cyclus::MockSim& sim, std::string commod, int t) {
+  std::vector<Cond> conds;
+  conds.push_back(Cond("Commodity", "==", commod));
+  conds.push_back(Cond("Time", "==", t));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  double tot = 0;
+  for (int i = 0; i < qr.rows.size(); i++) {
+    tot += sim.GetMaterial(qr.GetVal<int>("ResourceId", i))->quantity();
+  }
+  return tot;
+}
+
+// each stream gets its efficiency of each element and the rest is leftover.
+TEST(SeparationsTests, Split) {
+  int simdur = 2;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Separations"), effs,
+                      simdur);
+  sim.AddSource("spent").recipe("spent").capacity(101.8).Finalize();
+  sim.AddSink("pu").Finalize();
+  sim.AddSink("u").Finalize();
+  sim.AddSink("waste").Finalize();
+  sim.AddRecipe("spent", c_spent());
+  sim.Run();
+
+  // received at t=0, separated at the end of it and offered from t=1
+  EXPECT_NEAR(0.99, traded(sim, "pu", 1), 1e-6);
+  EXPECT_NEAR(50.4, traded(sim, "u", 1), 1e-6);
+  EXPECT_NEAR(101.8 - 0.99 - 50.4, traded(sim, "waste", 1), 1e-6);
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("Commodity", "==", std::string("pu")));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  Material::Ptr m = sim.GetMaterial(qr.GetVal<int>("ResourceId"));
+  MatQuery mq(m);
+  EXPECT_NEAR(0.99, mq.mass(id("pu239")), 1e-6);
+  EXPECT_NEAR(0, mq.mass(id("u238")), 1e-6);
+}
+
+// feed received in several batches of different compositions is absorbed
+// into one material - and split by the fractions of the mix.
+TEST(SeparationsTests, AbsorbedFeed) {
+  int simdur = 2;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Separations"), effs,
+                      simdur);
+  sim.AddSource("spent").recipe("spent").capacity(101.8).Finalize();
+  sim.AddSource("spent").recipe("depleted").capacity(100).Finalize();
+  sim.AddSink("pu").Finalize();
+  sim.AddSink("u").Finalize();
+  sim.AddSink("waste").Finalize();
+  sim.AddRecipe("spent", c_spent());
+  sim.AddRecipe("depleted", c_depleted());
+  sim.Run();
+
+  EXPECT_NEAR(0.99, traded(sim, "pu", 1), 1e-6);
+  EXPECT_NEAR(0.5 * 200.8, traded(sim, "u", 1), 1e-6);
+  EXPECT_NEAR(201.8 - 0.99 - 0.5 * 200.8, traded(sim, "waste", 1), 1e-6);
+}
+
+// a restored facility separates its feed like the one it was restored from.
+TEST(SeparationsTests, Restore) {
+  std::string config = effs + "  <throughput>20.36</throughput>  ";
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Separations"), config, 1);
+  sim.AddSource("spent").recipe("spent").capacity(101.8).Finalize();
+  sim.AddRecipe("spent", c_spent());
+  sim.Run();
+  Separations* sep = dynamic_cast<Separations*>(sim.agent);
+  ASSERT_TRUE(sep != NULL);
+  cyclus::Inventories invs = sep->SnapshotInv();
+  ASSERT_NEAR(0.99 / 5, total(invs["stream pu"]), 1e-6);
+
+  // a clone that is given the inventories but never entered the simulation -
+  // as on a restart
+  Separations* restored =
+      sep->context()->CreateAgent<Separations>(sep->prototype());
+  restored->InitInv(invs);
+  restored->Tock();
+  cyclus::Inventories after = restored->SnapshotInv();
+  EXPECT_NEAR(2 * 0.99 / 5, total(after["stream pu"]), 1e-6);
+  EXPECT_NEAR(2 * 50.4 / 5, total(after["stream u"]), 1e-6);
+  EXPECT_NEAR(101.8 * 3 / 5, total(after["feed"]), 1e-6);
+}
+
+// no more than throughput kg of feed are separated per time step.
+TEST(SeparationsTests, Throughput) {
+  std::string config = effs + "  <throughput>20.36</throughput>  ";
+  int simdur = 4;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Separations"), config,
+                      simdur);
+  sim.AddSource("spent").recipe("spent").capacity(101.8).Finalize();
+  sim.AddSink("u").Finalize();
+  sim.AddRecipe("spent", c_spent());
+  sim.Run();
+
+  // a fifth of the feed each time step
+  for (int t = 1; t < simdur; t++) {
+    EXPECT_NEAR(50.4 / 5, traded(sim, "u", t), 1e-6) << "t=" << t;
+  }
+}
+
+// a full stream buffer holds back separation.
+TEST(SeparationsTests, StreamCaps) {
+  std::string config = effs +
+      "  <stream_caps> <val>1e299</val> <val>10.08</val> </stream_caps>  ";
+  int simdur = 3;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Separations"), config,
+                      simdur);
+  sim.AddSource("spent").recipe("spent").capacity(101.8).Finalize();
+  sim.AddSink("pu").Finalize();
+  sim.AddRecipe("spent", c_spent());
+  sim.Run();
+
+  // the u stream is never traded away - only a fifth of the first feed is
+  // separated.
+  EXPECT_NEAR(0.99 / 5, traded(sim, "pu", 1), 1e-6);
+  EXPECT_NEAR(0, traded(sim, "pu", 2), 1e-6);
+}
+
+// the efficiencies of an element can't sum to more than 1.
+TEST(SeparationsTests, BadEfficiencies) {
+  std::string config =
+      "  <feed_commods> <val>spent</val> </feed_commods>  "
+      "  <streams> <val>pu</val> <val>pu2</val> </streams>  "
+      "  <eff_streams> <val>pu</val> <val>pu2</val> </eff_streams>  "
+      "  <eff_elems>   <val>Pu</val> <val>Pu</val> </eff_elems>  "
+      "  <eff_values>  <val>0.6</val> <val>0.6</val> </eff_values>  "
+      "  <leftover_commod>waste</leftover_commod>  ";
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Separations"), config, 1);
+  EXPECT_THROW(sim.Run(), cyclus::ValueError);
+}
+
+// separators bid for on many threads at once make the same bids as ones bid
+// for one at a time.
+TEST(SeparationsTests, ParallelBids) {
+  std::string config = effs + "  <throughput>20.36</throughput>  ";
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Separations"), config, 2);
+  sim.AddSource("spent").recipe("spent").capacity(101.8).Finalize();
+  sim.AddRecipe("spent", c_spent());
+  sim.Run();
+  Separations* sep = dynamic_cast<Separations*>(sim.agent);
+  ASSERT_TRUE(sep != NULL);
+  cyclus::Inventories full = sep->SnapshotInv();
+  ASSERT_GT(full["stream pu"].size(), 0);
+  ASSERT_GT(full["stream u"].size(), 0);
+
+  // two identical sets of separators - every third one without a u stream -
+  // one bid for in parallel and one serially
+  int n = 300;
+  std::vector<Separations*> par;
+  std::vector<Separations*> ser;
+  for (int i = 0; i < n; i++) {
+    cyclus::Inventories invs = full;
+    if (i % 3 == 0) {
+      invs.erase("stream u");
+    }
+    Separations* a =
+        sep->context()->CreateAgent<Separations>(sep->prototype());
+    a->InitInv(invs);
+    par.push_back(a);
+    Separations* b =
+        sep->context()->CreateAgent<Separations>(sep->prototype());
+    b->InitInv(invs);
+    ser.push_back(b);
+  }
+
+  cyclus::CommodMap<Material>::type reqs;
+  std::string commods[] = {"pu", "u", "waste"};
+  for (int i = 0; i < 3; i++) {
+    Material::Ptr target = Material::CreateUntracked(i + 1, c_spent());
+    reqs[commods[i]].push_back(
+        cyclus::Request<Material>::Create(target, sep, commods[i]));
+  }
+
+  std::vector<BidSet> par_bids = BidInParallel(par, reqs, 8);
+
+  for (int i = 0; i < n; i++) {
+    BidSet ser_bids = ser[i]->GetMatlBids(reqs);
+    ASSERT_EQ(ser_bids.size(), par_bids[i].size()) << "separator " << i;
+    EXPECT_EQ(DescribeBids(ser_bids), DescribeBids(par_bids[i]))
+        << "separator " << i;
+  }
+}
+
+}  // namespace separationstests
+}  // namespace cycamore
@@ -4,6 +4,7 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include "instrument.h"
 #include "sink.h"
 
 namespace cycamore {
@@ -59,6 +60,7 @@ std::string Sink::str() {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>
 Sink::GetMatlRequests() {
+  CYCAMORE_TIME("GetMatlRequests");
   using cyclus::Material;
   using cyclus::RequestPortfolio;
   using cyclus::Request;
@@ -73,8 +75,9 @@ Sink::GetMatlRequests() {
     mat = cyclus::NewBlankMaterial(amt);
   } else {
     Composition::Ptr rec = this->context()->GetRecipe(recipe_name);
-    mat = cyclus::Material::CreateUntracked(amt, rec); 
-  } 
+    targets_.Reset(context()->time());
+    mat = targets_.Get(amt, rec);
+  }
 
   if (amt > cyclus::eps()) {
     std::vector<std::string>::const_iterator it;
@@ -86,12 +89,14 @@ Sink::GetMatlRequests() {
     ports.insert(port);
   }  // if amt > eps
 
+  CYCAMORE_COUNT_REQUESTS(ports);
   return ports;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 std::set<cyclus::RequestPortfolio<cyclus::Product>::Ptr>
 Sink::GetGenRsrcRequests() {
+  CYCAMORE_TIME("GetGenRsrcRequests");
   using cyclus::CapacityConstraint;
   using cyclus::Product;
   using cyclus::RequestPortfolio;
@@ -116,6 +121,7 @@ Sink::GetGenRsrcRequests() {
     ports.insert(port);
   }  // if amt > eps
 
+  CYCAMORE_COUNT_REQUESTS(ports);
   return ports;
 }
 
@@ -123,6 +129,7 @@ Sink::GetGenRsrcRequests() {
 void Sink::AcceptMatlTrades(
     const std::vector< std::pair<cyclus::Trade<cyclus::Material>,
                                  cyclus::Material::Ptr> >& responses) {
+  CYCAMORE_TIME("AcceptMatlTrades");
   std::vector< std::pair<cyclus::Trade<cyclus::Material>,
                          cyclus::Material::Ptr> >::const_iterator it;
   for (it = responses.begin(); it != responses.end(); ++it) {
@@ -134,6 +141,7 @@ void Sink::AcceptMatlTrades(
 void Sink::AcceptGenRsrcTrades(
     const std::vector< std::pair<cyclus::Trade<cyclus::Product>,
                                  cyclus::Product::Ptr> >& responses) {
+  CYCAMORE_TIME("AcceptGenRsrcTrades");
   std::vector< std::pair<cyclus::Trade<cyclus::Product>,
                          cyclus::Product::Ptr> >::const_iterator it;
   for (it = responses.begin(); it != responses.end(); ++it) {
@@ -143,6 +151,7 @@ void Sink::AcceptGenRsrcTrades(
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Sink::Tick() {
+  CYCAMORE_TIME("Tick");
   using std::string;
   using std::vector;
   LOG(cyclus::LEV_INFO3, "SnkFac") << prototype() << " is ticking {";
@@ -162,6 +171,7 @@ void Sink::Tick() {
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Sink::Tock() {
+  CYCAMORE_TIME("Tock");
   LOG(cyclus::LEV_INFO3, "SnkFac") << prototype() << " is tocking {";
 
   // On the tock, the sink facility doesn't really do much.
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "cyclus.h"
+#include "untracked_pool.h"
 
 namespace cycamore {
 
@@ -190,6 +191,9 @@ class Sink : public cyclus::Facility  {
   /// this facility holds material in storage.
   #pragma cyclus var {'capacity': 'max_inv_size'}
   cyclus::toolkit::ResourceBuff inventory;
+
+  /// request targets
+  UntrackedPool targets_;
 };
 
 }  // namespace cycamore
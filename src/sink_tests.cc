@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include "alloc_counter.h"
 #include "facility_tests.h"
 #include "agent_tests.h"
 #include "resource_helpers.h"
@@ -133,6 +134,29 @@ TEST_F(SinkTest, Requests) {
   EXPECT_EQ(constraints.size(), 0);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(SinkTest, RequestAllocs) {
+  using cyclus::Material;
+  using cyclus::RequestPortfolio;
+
+  // per call: the portfolio and its count (2), the blank request material
+  // and its composition with their counts and decay chain (6), the
+  // portfolio's set node and the copy of the returned set (2) - plus a margin
+  // of 2
+  const long call_budget = 12;
+  // per commodity: the request, its entries in the portfolio's request list
+  // and mutual request multipliers and in the list of mutual requests (4) -
+  // plus a margin of 1
+  const long commod_budget = 5;
+
+  std::set<RequestPortfolio<Material>::Ptr> ports =
+      src_facility->GetMatlRequests();
+  ports.clear();
+
+  EXPECT_ALLOCS_LE(call_budget + ncommods_ * commod_budget,
+                   ports = src_facility->GetMatlRequests());
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST_F(SinkTest, EmptyRequests) {
   using cyclus::Material;
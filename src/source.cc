@@ -5,6 +5,8 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include "instrument.h"
+
 namespace cycamore {
 
 Source::Source(cyclus::Context* ctx)
@@ -48,9 +50,11 @@ std::string Source::str() {
 
 std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Source::GetMatlBids(
     cyclus::CommodMap<cyclus::Material>::type& commod_requests) {
+  CYCAMORE_TIME("GetMatlBids");
   using cyclus::Bid;
   using cyclus::BidPortfolio;
   using cyclus::CapacityConstraint;
+  using cyclus::Composition;
   using cyclus::Material;
   using cyclus::Request;
 
@@ -60,29 +64,34 @@ std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Source::GetMatlBids(
   LOG(cyclus::LEV_INFO5, "Source") << "stats: " << str();
 
   std::set<BidPortfolio<Material>::Ptr> ports;
+  cyclus::CommodMap<Material>::type::const_iterator found =
+      commod_requests.find(outcommod);
   if (max_qty < cyclus::eps()) {
     return ports;
-  } else if (commod_requests.count(outcommod) == 0) {
+  } else if (found == commod_requests.end()) {
     return ports;
   }
 
   BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
-  std::vector<Request<Material>*>& requests = commod_requests[outcommod];
-  std::vector<Request<Material>*>::iterator it;
+  const std::vector<Request<Material>*>& requests = found->second;
+  std::vector<Request<Material>*>::const_iterator it;
+  Composition::Ptr recipe;
+  if (!outrecipe.empty()) {
+    recipe = context()->GetRecipe(outrecipe);
+  }
+  offers_.Reset(context()->time());
   for (it = requests.begin(); it != requests.end(); ++it) {
     Request<Material>* req = *it;
     Material::Ptr target = req->target();
     double qty = std::min(target->quantity(), max_qty);
-    Material::Ptr m = Material::CreateUntracked(qty, target->comp());
-    if (!outrecipe.empty()) {
-      m = Material::CreateUntracked(qty, context()->GetRecipe(outrecipe));
-    }
+    Material::Ptr m = offers_.Get(qty, recipe ? recipe : target->comp());
     port->AddBid(req, m, this);
   }
 
   CapacityConstraint<Material> cc(max_qty);
   port->AddConstraint(cc);
   ports.insert(port);
+  CYCAMORE_COUNT_BIDS(ports);
   return ports;
 }
 
@@ -90,6 +99,7 @@ void Source::GetMatlTrades(
     const std::vector<cyclus::Trade<cyclus::Material> >& trades,
     std::vector<std::pair<cyclus::Trade<cyclus::Material>,
                           cyclus::Material::Ptr> >& responses) {
+  CYCAMORE_TIME("GetMatlTrades");
   using cyclus::Material;
   using cyclus::Trade;
 
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "cyclus.h"
+#include "untracked_pool.h"
 
 namespace cycamore {
 
@@ -100,6 +101,9 @@ class Source : public cyclus::Facility,
     "units": "kg", \
   }
   double inventory_size;
+
+  /// bid offers
+  UntrackedPool offers_;
 };
 
 }  // namespace cycamore
@@ -4,7 +4,9 @@
 
 #include <sstream>
 
+#include "alloc_counter.h"
 #include "cyc_limits.h"
+#include "parallel_bids.h"
 #include "resource_helpers.h"
 #include "test_context.h"
 
@@ -80,6 +82,80 @@ TEST_F(SourceTest, AddBids) {
   EXPECT_EQ(*constrs.begin(), CapacityConstraint<Material>(capacity));
 }
 
+TEST_F(SourceTest, BidAllocs) {
+  using cyclus::BidPortfolio;
+  using cyclus::ExchangeContext;
+  using cyclus::Material;
+
+  // per call: the portfolio and its count (2), the capacity constraint's
+  // converter and its count (2), the constraint's and the portfolio's set
+  // nodes (2) and the copy of the returned set (1) - plus a margin of 2
+  const long call_budget = 9;
+  // per request: the bid and its set node in the portfolio - the offers are
+  // pooled from the first call - plus a margin of 1
+  const long req_budget = 3;
+
+  int nreqs = 5;
+  boost::shared_ptr<ExchangeContext<Material> > ec = GetContext(nreqs, commod);
+  boost::shared_ptr<ExchangeContext<Material> > ec2 =
+      GetContext(2 * nreqs, commod);
+  cyclus::CommodMap<Material>::type& reqs = ec->commod_requests;
+  cyclus::CommodMap<Material>::type& reqs2 = ec2->commod_requests;
+
+  std::set<BidPortfolio<Material>::Ptr> ports =
+      src_facility->GetMatlBids(reqs);
+  ports.clear();
+
+  cycamore::AllocCounter allocs;
+  ports = src_facility->GetMatlBids(reqs);
+  long n = allocs.count();
+  EXPECT_LE(n, call_budget + nreqs * req_budget);
+  ports.clear();
+
+  allocs.reset();
+  ports = src_facility->GetMatlBids(reqs2);
+  long n2 = allocs.count();
+  EXPECT_LE(n2 - n, nreqs * req_budget)
+      << "allocations per request bid on exceed the budget";
+}
+
+TEST_F(SourceTest, PooledOffers) {
+  using cyclus::Bid;
+  using cyclus::BidPortfolio;
+  using cyclus::ExchangeContext;
+  using cyclus::Material;
+  using cyclus::Request;
+
+  int nreqs = 5;
+  boost::shared_ptr<ExchangeContext<Material> > ec = GetContext(nreqs, commod);
+  cyclus::CommodMap<Material>::type& reqs = ec->commod_requests;
+
+  cycamore::AllocCounter allocs;
+  std::set<BidPortfolio<Material>::Ptr> ports =
+      src_facility->GetMatlBids(reqs);
+  long cold = allocs.count();
+
+  std::map<Request<Material>*, Material::Ptr> offers;
+  std::set<Bid<Material>*>::const_iterator it;
+  const std::set<Bid<Material>*>& bids = (*ports.begin())->bids();
+  for (it = bids.begin(); it != bids.end(); ++it) {
+    offers[(*it)->request()] = (*it)->offer();
+  }
+  ports.clear();
+
+  // bidding on the same requests again reuses the offers
+  allocs.reset();
+  ports = src_facility->GetMatlBids(reqs);
+  long warm = allocs.count();
+  EXPECT_LT(warm, cold);
+
+  const std::set<Bid<Material>*>& bids2 = (*ports.begin())->bids();
+  ASSERT_EQ(nreqs, bids2.size());
+  for (it = bids2.begin(); it != bids2.end(); ++it) {
+    EXPECT_EQ(offers[(*it)->request()], (*it)->offer());
+  }
+}
+
 TEST_F(SourceTest, Response) {
   using cyclus::Bid;
   using cyclus::Material;
@@ -123,6 +199,52 @@ TEST_F(SourceTest, Response) {
   delete bid;
 }
 
+TEST_F(SourceTest, ParallelBids) {
+  using cyclus::Material;
+
+  // two identical sets of sources of various throughputs - every third one
+  // without a recipe, offering the requested compositions - one bid for in
+  // parallel and one serially
+  int n = 300;
+  std::vector<Source*> par;
+  std::vector<Source*> ser;
+  for (int i = 0; i < n; i++) {
+    for (int k = 0; k < 2; k++) {
+      Source* s = dynamic_cast<Source*>(src_facility->Clone());
+      throughput(s, 1 + i % 7);
+      if (i % 3 == 0) {
+        outrecipe(s, "");
+      }
+      (k == 0 ? par : ser).push_back(s);
+    }
+  }
+
+  // requested compositions defined by mass, shared by all the sources
+  cyclus::CommodMap<Material>::type reqs;
+  for (int i = 1; i <= 3; i++) {
+    cyclus::CompMap v;
+    v[922350000] = 0.01 * i;
+    v[922380000] = 1 - 0.01 * i;
+    Material::Ptr target = Material::CreateUntracked(
+        2 * i, cyclus::Composition::CreateFromMass(v));
+    reqs[commod].push_back(
+        cyclus::Request<Material>::Create(target, trader, commod));
+  }
+
+  std::vector<BidSet> par_bids = BidInParallel(par, reqs, 8);
+
+  for (int i = 0; i < n; i++) {
+    BidSet ser_bids = ser[i]->GetMatlBids(reqs);
+    ASSERT_EQ(ser_bids.size(), par_bids[i].size()) << "source " << i;
+    EXPECT_EQ(DescribeBids(ser_bids), DescribeBids(par_bids[i]))
+        << "source " << i;
+  }
+  for (int i = 0; i < n; i++) {
+    delete par[i];
+    delete ser[i];
+  }
+}
+
 boost::shared_ptr< cyclus::ExchangeContext<cyclus::Material> >
 SourceTest::GetContext(int nreqs, std::string commod) {
   using cyclus::Material;
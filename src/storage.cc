@@ -0,0 +1,185 @@
+#include "storage.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include "instrument.h"
+
+using cyclus::Material;
+using cyclus::Composition;
+
+namespace cycamore {
+
+Storage::Storage(cyclus::Context* ctx)
+    : cyclus::Facility(ctx),
+      residence_time(0),
+      throughput(std::numeric_limits<double>::max()),
+      max_inv_size(std::numeric_limits<double>::max()) {}
+
+#pragma cyclus def clone cycamore::Storage
+
+#pragma cyclus def schema cycamore::Storage
+
+#pragma cyclus def annotations cycamore::Storage
+
+#pragma cyclus def infiletodb cycamore::Storage
+
+#pragma cyclus def snapshot cycamore::Storage
+
+#pragma cyclus def snapshotinv cycamore::Storage
+
+#pragma cyclus def initinv cycamore::Storage
+
+#pragma cyclus def initfromcopy cycamore::Storage
+
+#pragma cyclus def initfromdb cycamore::Storage
+
+std::string Storage::str() {
+  std::stringstream ss;
+  ss << cyclus::Facility::str() << " stores material for " << residence_time
+     << " time steps before offering it as '" << out_commod << "' - holding "
+     << waiting.quantity() << " kg waiting and " << ready.quantity()
+     << " kg ready";
+  return ss.str();
+}
+
+void Storage::EnterNotify() {
+  cyclus::Facility::EnterNotify();
+
+  if (residence_time < 0) {
+    std::stringstream ss;
+    ss << "prototype '" << prototype() << "' has residence_time "
+       << residence_time << ", expected at least 0";
+    throw cyclus::ValueError(ss.str());
+  }
+  // one bucket for each time step material can be waiting - kept across
+  // restarts
+  bucket_sizes.resize(residence_time, 0);
+}
+
+void Storage::Tick() {
+  CYCAMORE_TIME("Tick");
+  if (residence_time == 0) {
+    return;
+  }
+  // the bucket of residence_time steps ago is the one this step receives into
+  int& n = bucket_sizes[bucket(context()->time())];
+  if (n > 0) {
+    ready.Push(waiting.PopN(n));
+    n = 0;
+  }
+}
+
+void Storage::Tock() {
+  CYCAMORE_TIME("Tock");
+  LOG(cyclus::LEV_INFO4, "Storag") << prototype() << " holds "
+                                   << waiting.quantity() << " kg waiting and "
+                                   << ready.quantity() << " kg ready.";
+}
+
+std::set<cyclus::RequestPortfolio<Material>::Ptr> Storage::GetMatlRequests() {
+  CYCAMORE_TIME("GetMatlRequests");
+  using cyclus::RequestPortfolio;
+  using cyclus::Request;
+
+  std::set<RequestPortfolio<Material>::Ptr> ports;
+  double amt = std::min(throughput, max_inv_size - InventorySize());
+  if (amt < cyclus::eps()) {
+    return ports;
+  }
+
+  Material::Ptr m;
+  if (in_recipe.empty()) {
+    m = cyclus::NewBlankMaterial(amt);
+  } else {
+    targets_.Reset(context()->time());
+    m = targets_.Get(amt, context()->GetRecipe(in_recipe));
+  }
+
+  RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
+  std::vector<Request<Material>*> mutuals;
+  for (int i = 0; i < in_commods.size(); i++) {
+    mutuals.push_back(port->AddRequest(m, this, in_commods[i]));
+  }
+  port->AddMutualReqs(mutuals);
+  ports.insert(port);
+  CYCAMORE_COUNT_REQUESTS(ports);
+  return ports;
+}
+
+void Storage::AcceptMatlTrades(const std::vector<std::pair<
+    cyclus::Trade<Material>, Material::Ptr> >& responses) {
+  CYCAMORE_TIME("AcceptMatlTrades");
+  std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >::
+      const_iterator it;
+  for (it = responses.begin(); it != responses.end(); ++it) {
+    if (residence_time == 0) {
+      ready.Push(it->second);
+    } else {
+      waiting.Push(it->second);
+      bucket_sizes[bucket(context()->time())]++;
+    }
+  }
+}
+
+std::set<cyclus::BidPortfolio<Material>::Ptr> Storage::GetMatlBids(
+    cyclus::CommodMap<Material>::type& commod_requests) {
+  CYCAMORE_TIME("GetMatlBids");
+  using cyclus::BidPortfolio;
+  using cyclus::CapacityConstraint;
+  using cyclus::Request;
+
+  std::set<BidPortfolio<Material>::Ptr> ports;
+  double avail = ready.quantity();
+  cyclus::CommodMap<Material>::type::const_iterator found =
+      commod_requests.find(out_commod);
+  if (avail < cyclus::eps()) {
+    return ports;
+  } else if (found == commod_requests.end()) {
+    return ports;
+  }
+
+  // one offer per request on the whole ready aggregate - its composition is
+  // that of the material that would be traded away first, not of the mix a
+  // larger trade takes (see the class doc).
+  Composition::Ptr c = ready.Peek()->comp();
+  offers_.Reset(context()->time());
+  BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
+  const std::vector<Request<Material>*>& reqs = found->second;
+  for (int i = 0; i < reqs.size(); i++) {
+    Request<Material>* req = reqs[i];
+    double qty = std::min(req->target()->quantity(), avail);
+    port->AddBid(req, offers_.Get(qty, c), this);
+  }
+
+  CapacityConstraint<Material> cc(avail);
+  port->AddConstraint(cc);
+  ports.insert(port);
+  CYCAMORE_COUNT_BIDS(ports);
+  return ports;
+}
+
+void Storage::GetMatlTrades(
+    const std::vector<cyclus::Trade<Material> >& trades,
+    std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
+        responses) {
+  CYCAMORE_TIME("GetMatlTrades");
+  for (int i = 0; i < trades.size(); i++) {
+    double qty = trades[i].amt;
+    Material::Ptr m;
+    // required so popping doesn't fail on round off
+    if (cyclus::AlmostEq(qty, ready.quantity())) {
+      m = cyclus::toolkit::Squash(ready.PopN(ready.count()));
+    } else {
+      m = ready.Pop(qty);
+    }
+    responses.push_back(std::make_pair(trades[i], m));
+  }
+}
+
+extern "C" cyclus::Agent* ConstructStorage(cyclus::Context* ctx) {
+  return new Storage(ctx);
+}
+
+}  // namespace cycamore
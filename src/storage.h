@@ -0,0 +1,135 @@
+#ifndef CYCAMORE_SRC_STORAGE_H_
+#define CYCAMORE_SRC_STORAGE_H_
+
+#include <string>
+#include <vector>
+
+#include "cyclus.h"
+#include "untracked_pool.h"
+
+namespace cycamore {
+
+/// Storage holds the material it receives for residence_time time steps -
+/// e.g. spent fuel in a cooling pool - before offering it on out_commod.
+///
+/// Material is kept in arrival order in a single waiting buffer, and the
+/// number of materials received on each of the last residence_time time
+/// steps in a ring of per-time-step buckets.  Each time step the bucket
+/// received residence_time steps ago matures: that many materials move from
+/// the front of the waiting buffer to the ready buffer and the bucket is
+/// reused for the current time step.  Receiving and releasing material thus
+/// costs the same no matter how much is stored.  Bids are made on the
+/// aggregate of the ready buffer only, and carry the composition of the
+/// oldest ready material alone: requesters with composition-dependent
+/// preferences see that composition even when the material traded away is a
+/// mix of several ready materials.
+class Storage : public cyclus::Facility {
+#pragma cyclus note { \
+"doc": \
+  "Storage holds the material it receives for residence_time time steps" \
+  " - e.g. spent fuel in a cooling pool - before offering it on out_commod." \
+  "  It requests up to throughput kg per time step on its input commodities" \
+  " while it holds less than max_inv_size kg.  Material that has been held" \
+  " for residence_time time steps is offered as a single aggregate, and" \
+  " traded away in arrival order.  Offers carry the composition of the" \
+  " oldest ready material only, even when a trade takes a mix of several" \
+  " ready materials.", \
+}
+
+ public:
+  Storage(cyclus::Context* ctx);
+  virtual ~Storage() {};
+
+  virtual std::string str();
+
+  virtual void EnterNotify();
+  virtual void Tick();
+  virtual void Tock();
+
+  virtual void AcceptMatlTrades(const std::vector<std::pair<
+      cyclus::Trade<cyclus::Material>, cyclus::Material::Ptr> >& responses);
+
+  virtual std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>
+  GetMatlRequests();
+
+  virtual std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> GetMatlBids(
+      cyclus::CommodMap<cyclus::Material>::type& commod_requests);
+
+  virtual void GetMatlTrades(
+      const std::vector<cyclus::Trade<cyclus::Material> >& trades,
+      std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                            cyclus::Material::Ptr> >& responses);
+
+  #pragma cyclus decl
+
+  /// @return the quantity of material held - waiting and ready
+  inline double InventorySize() const {
+    return waiting.quantity() + ready.quantity();
+  }
+
+ private:
+  /// Returns the ring bucket of time step t.
+  inline int bucket(int t) const { return t % residence_time; }
+
+  #pragma cyclus var { \
+    "uitype": ["oneormore", "incommodity"], \
+    "doc": "Commodities on which to request material to store.", \
+  }
+  std::vector<std::string> in_commods;
+
+  #pragma cyclus var { \
+    "default": "", \
+    "uitype": "recipe", \
+    "doc": "Recipe of the material to request, where the default (empty" \
+           " string) is to accept everything.", \
+  }
+  std::string in_recipe;
+
+  #pragma cyclus var { \
+    "uitype": "outcommodity", \
+    "doc": "Commodity on which to offer material once it has been stored for" \
+           " residence_time time steps.", \
+  }
+  std::string out_commod;
+
+  #pragma cyclus var { \
+    "doc": "Number of time steps material is held before it is offered.", \
+    "units": "time steps", \
+  }
+  int residence_time;
+
+  #pragma cyclus var { \
+    "default": 1e299, \
+    "doc": "Maximum amount of material received per time step.", \
+    "units": "kg/(time step)", \
+  }
+  double throughput;
+
+  #pragma cyclus var { \
+    "default": 1e299, \
+    "doc": "Maximum amount of material held - waiting and ready.", \
+    "units": "kg", \
+  }
+  double max_inv_size;
+
+  // should be hidden in ui (internal only). Number of materials received on
+  // each of the last residence_time time steps - time step t in bucket(t).
+  #pragma cyclus var {"default": [], "doc": "This should NEVER be set manually."}
+  std::vector<int> bucket_sizes;
+
+  // Material held for less than residence_time time steps, in arrival order.
+  #pragma cyclus var {}
+  cyclus::toolkit::ResBuf<cyclus::Material> waiting;
+
+  // Material that has been held for residence_time time steps.
+  #pragma cyclus var {}
+  cyclus::toolkit::ResBuf<cyclus::Material> ready;
+
+  /// request targets and bid offers
+  UntrackedPool targets_;
+  UntrackedPool offers_;
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_STORAGE_H_
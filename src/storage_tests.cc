@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include "cyclus.h"
+#include "parallel_bids.h"
+#include "storage.h"
+
+using cyclus::Composition;
+using cyclus::Cond;
+using cyclus::Material;
+using cyclus::QueryResult;
+using pyne::nucname::id;
+
+namespace cycamore {
+namespace storagetests {
+
+Composition::Ptr c_spent() {
+  cyclus::CompMap m;
+  m[id("u235")] = .8;
+  m[id("u238")] = 100;
+  m[id("pu239")] = 1;
+  return Composition::CreateFromMass(m);
+};
+
+const std::string commods =
+    "  <in_commods> <val>spent</val> </in_commods>  "
+    "  <out_commod>cooled</out_commod>  ";
+
+QueryResult transactions(cyclus::MockSim& sim, std::string commod) {
+  std::vector<Cond> conds;
+  conds.push_back(Cond("Commodity", "==", commod));
+  return sim.db().Query("Transactions", &conds);
+}
+
+// material is offered exactly residence_time time steps after it arrives.
+TEST(StorageTests, ResidenceTime) {
+  std::string config = commods +
+     "  <residence_time>3</residence_time>  "
+     "  <throughput>10</throughput>  ";
+
+  int simdur = 8;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Storage"), config, simdur);
+  sim.AddSource("spent").recipe("spent").Finalize();
+  sim.AddSink("cooled").Finalize();
+  sim.AddRecipe("spent", c_spent());
+  sim.Run();
+
+  QueryResult in = transactions(sim, "spent");
+  EXPECT_EQ(simdur, in.rows.size());
+  QueryResult out = transactions(sim, "cooled");
+  ASSERT_EQ(simdur - 3, out.rows.size());
+  for (int i = 0; i < out.rows.size(); i++) {
+    EXPECT_LE(3, out.GetVal<int>("Time", i));
+    Material::Ptr m = sim.GetMaterial(out.GetVal<int>("ResourceId", i));
+    EXPECT_DOUBLE_EQ(10, m->quantity());
+  }
+}
+
+// nothing is received once the storage is full, and received material can
+// always leave right away without a residence time.
+TEST(StorageTests, MaxInventory) {
+  std::string config = commods +
+     "  <residence_time>0</residence_time>  "
+     "  <throughput>10</throughput>  "
+     "  <max_inv_size>25</max_inv_size>  ";
+
+  int simdur = 5;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Storage"), config, simdur);
+  sim.AddSource("spent").recipe("spent").Finalize();
+  sim.AddRecipe("spent", c_spent());
+  sim.Run();
+
+  QueryResult in = transactions(sim, "spent");
+  double tot = 0;
+  for (int i = 0; i < in.rows.size(); i++) {
+    tot += sim.GetMaterial(in.GetVal<int>("ResourceId", i))->quantity();
+  }
+  EXPECT_DOUBLE_EQ(25, tot);
+}
+
+// matured batches are offered as a single aggregate.
+TEST(StorageTests, Aggregate) {
+  std::string config = commods +
+     "  <residence_time>2</residence_time>  "
+     "  <throughput>10</throughput>  ";
+
+  int simdur = 6;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Storage"), config, simdur);
+  sim.AddSource("spent").recipe("spent").Finalize();
+  sim.AddSink("cooled").capacity(6).Finalize();
+  sim.AddRecipe("spent", c_spent());
+  sim.Run();
+
+  // 10 kg mature each time step from t=2 on and 6 kg are taken each time -
+  // in one trade even when they come from more than one batch.
+  QueryResult out = transactions(sim, "cooled");
+  ASSERT_EQ(simdur - 2, out.rows.size());
+  for (int i = 0; i < out.rows.size(); i++) {
+    Material::Ptr m = sim.GetMaterial(out.GetVal<int>("ResourceId", i));
+    EXPECT_NEAR(6, m->quantity(), 1e-6);
+  }
+}
+
+// storages bid for on many threads at once make the same bids as ones bid
+// for one at a time.
+TEST(StorageTests, ParallelBids) {
+  std::string config = commods +
+     "  <residence_time>1</residence_time>  "
+     "  <throughput>10</throughput>  ";
+
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Storage"), config, 3);
+  sim.AddSource("spent").recipe("spent").Finalize();
+  sim.AddRecipe("spent", c_spent());
+  sim.Run();
+  Storage* store = dynamic_cast<Storage*>(sim.agent);
+  ASSERT_TRUE(store != NULL);
+  cyclus::Inventories full = store->SnapshotInv();
+  ASSERT_GT(full["ready"].size(), 0);
+
+  // two identical sets of storages - every third one with nothing ready -
+  // one bid for in parallel and one serially
+  int n = 300;
+  std::vector<Storage*> par;
+  std::vector<Storage*> ser;
+  for (int i = 0; i < n; i++) {
+    cyclus::Inventories invs = full;
+    if (i % 3 == 0) {
+      invs.erase("ready");
+    }
+    Storage* a = store->context()->CreateAgent<Storage>(store->prototype());
+    a->InitInv(invs);
+    par.push_back(a);
+    Storage* b = store->context()->CreateAgent<Storage>(store->prototype());
+    b->InitInv(invs);
+    ser.push_back(b);
+  }
+
+  cyclus::CommodMap<Material>::type reqs;
+  for (int i = 1; i <= 3; i++) {
+    Material::Ptr target = Material::CreateUntracked(4 * i, c_spent());
+    reqs["cooled"].push_back(
+        cyclus::Request<Material>::Create(target, store, "cooled"));
+  }
+
+  std::vector<BidSet> par_bids = BidInParallel(par, reqs, 8);
+
+  for (int i = 0; i < n; i++) {
+    BidSet ser_bids = ser[i]->GetMatlBids(reqs);
+    ASSERT_EQ(ser_bids.size(), par_bids[i].size()) << "storage " << i;
+    EXPECT_EQ(DescribeBids(ser_bids), DescribeBids(par_bids[i]))
+        << "storage " << i;
+  }
+}
+
+}  // namespace storagetests
+}  // namespace cycamore
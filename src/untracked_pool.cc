@@ -0,0 +1,60 @@
+#include "untracked_pool.h"
+
+#include "mutex.h"
+
+namespace cycamore {
+
+cyclus::Material::Ptr CreateUntracked(double qty,
+                                      cyclus::Composition::Ptr c) {
+  MutexLock lock(IdMutex());
+  return cyclus::Material::CreateUntracked(qty, c);
+}
+
+void UntrackedPool::Reset(int t) {
+  if (t == time_) {
+    return;
+  }
+  std::map<Key, Entry>::iterator it = pool_.begin();
+  while (it != pool_.end()) {
+    if (it->second.last < time_) {
+      pool_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  time_ = t;
+}
+
+cyclus::Material::Ptr UntrackedPool::Get(double qty,
+                                         cyclus::Composition::Ptr c) {
+  cyclus::Material::Ptr m = Find(qty, c);
+  if (!m) {
+    m = CreateUntracked(qty, c);
+    Put(qty, c, m);
+  }
+  return m;
+}
+
+cyclus::Material::Ptr UntrackedPool::Find(double qty,
+                                          cyclus::Composition::Ptr c) {
+  std::map<Key, Entry>::iterator it = pool_.find(Key(qty, c.get()));
+  if (it == pool_.end()) {
+    return cyclus::Material::Ptr();
+  }
+  it->second.last = time_;
+  return it->second.mat;
+}
+
+void UntrackedPool::Put(double qty, cyclus::Composition::Ptr c,
+                        cyclus::Material::Ptr m) {
+  Entry& e = pool_[Key(qty, c.get())];
+  e.mat = m;
+  e.comp = c;
+  e.last = time_;
+}
+
+void UntrackedPool::Clear() {
+  pool_.clear();
+}
+
+}  // namespace cycamore
@@ -0,0 +1,68 @@
+#ifndef CYCAMORE_SRC_UNTRACKED_POOL_H_
+#define CYCAMORE_SRC_UNTRACKED_POOL_H_
+
+#include <map>
+#include <utility>
+
+#include "cyclus.h"
+
+namespace cycamore {
+
+/// Returns a new untracked material of qty kg and composition c - made with
+/// IdMutex held, so it is safe to use while several agents bid at once.
+cyclus::Material::Ptr CreateUntracked(double qty, cyclus::Composition::Ptr c);
+
+/// Pooled untracked materials for use as request targets and bid offers.
+///
+/// Archetypes build a throwaway untracked material for every request and bid
+/// they make, and most of them are the same from one request - and one time
+/// step - to the next.  An UntrackedPool hands out one shared material per
+/// (quantity, composition) instead.  Materials are kept for the time step
+/// they were last handed out in and the one after it, so an archetype making
+/// the same requests or bids every time step allocates no new materials.
+///
+/// Pooled materials are shared between requests, bids and time steps and
+/// must never be modified.
+class UntrackedPool {
+ public:
+  UntrackedPool() : time_(-1) {}
+
+  /// Starts handing out materials for time step t - releasing the materials
+  /// that were not handed out during the previous one.  Does nothing if t is
+  /// the current time step.
+  void Reset(int t);
+
+  /// Returns an untracked material of qty kg and composition c.
+  cyclus::Material::Ptr Get(double qty, cyclus::Composition::Ptr c);
+
+  /// Returns the material stored with Put for qty kg of composition c, or a
+  /// null pointer if there is none.  For materials that are derived from c
+  /// rather than made of it.
+  cyclus::Material::Ptr Find(double qty, cyclus::Composition::Ptr c);
+
+  /// Stores material m to be returned by Find for qty kg of composition c.
+  void Put(double qty, cyclus::Composition::Ptr c, cyclus::Material::Ptr m);
+
+  /// Releases all materials.
+  void Clear();
+
+  /// Returns the number of pooled materials.
+  inline int size() const { return pool_.size(); }
+
+ private:
+  struct Entry {
+    cyclus::Material::Ptr mat;
+    /// keeps the key's composition alive so its address is not reused
+    cyclus::Composition::Ptr comp;
+    int last;
+  };
+
+  typedef std::pair<double, const cyclus::Composition*> Key;
+
+  int time_;
+  std::map<Key, Entry> pool_;
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_UNTRACKED_POOL_H_
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include "alloc_counter.h"
+#include "untracked_pool.h"
+
+using cyclus::Composition;
+using cyclus::Material;
+
+namespace cycamore {
+namespace untrackedpooltests {
+
+Composition::Ptr comp(double u235) {
+  cyclus::CompMap m;
+  m[922350000] = u235;
+  m[922380000] = 1 - u235;
+  return Composition::CreateFromMass(m);
+}
+
+TEST(UntrackedPoolTests, Get) {
+  Composition::Ptr c1 = comp(0.04);
+  Composition::Ptr c2 = comp(0.04);
+  UntrackedPool pool;
+  pool.Reset(0);
+
+  Material::Ptr m = pool.Get(10, c1);
+  EXPECT_DOUBLE_EQ(10, m->quantity());
+  EXPECT_EQ(c1, m->comp());
+  EXPECT_EQ(m, pool.Get(10, c1));
+  // pooled by composition identity, not content
+  EXPECT_NE(m, pool.Get(10, c2));
+  EXPECT_NE(m, pool.Get(11, c1));
+  EXPECT_EQ(3, pool.size());
+
+  // handing out a pooled material allocates nothing
+  Material::Ptr m2;
+  EXPECT_ALLOCS_LE(0, m2 = pool.Get(10, c1));
+  EXPECT_EQ(m, m2);
+}
+
+TEST(UntrackedPoolTests, Reset) {
+  Composition::Ptr c = comp(0.04);
+  UntrackedPool pool;
+  pool.Reset(0);
+  Material::Ptr m0 = pool.Get(1, c);
+  Material::Ptr m1 = pool.Get(2, c);
+
+  // materials handed out during the previous time step are kept
+  pool.Reset(1);
+  EXPECT_EQ(2, pool.size());
+  EXPECT_EQ(m1, pool.Get(2, c));
+
+  pool.Reset(1);
+  EXPECT_EQ(2, pool.size());
+
+  pool.Reset(2);
+  EXPECT_EQ(1, pool.size());
+  EXPECT_EQ(m1, pool.Get(2, c));
+  EXPECT_NE(m0, pool.Get(1, c));
+
+  pool.Clear();
+  EXPECT_EQ(0, pool.size());
+}
+
+TEST(UntrackedPoolTests, FindPut) {
+  Composition::Ptr c = comp(0.04);
+  UntrackedPool pool;
+  pool.Reset(0);
+  EXPECT_FALSE(pool.Find(10, c));
+
+  Material::Ptr derived = Material::CreateUntracked(10, comp(0.2));
+  pool.Put(10, c, derived);
+  EXPECT_EQ(derived, pool.Find(10, c));
+  EXPECT_EQ(derived, pool.Get(10, c));
+  EXPECT_FALSE(pool.Find(5, c));
+}
+
+}  // namespace untrackedpooltests
+}  // namespace cycamore
@@ -0,0 +1,93 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+// Replacements for the global allocation functions that keep a running count
+// of allocations.  Only linked into cycamore_unit_tests.
+
+#if __cplusplus >= 201103L
+#define CYCAMORE_THROW_BAD_ALLOC
+#define CYCAMORE_NOTHROW noexcept
+#else
+#define CYCAMORE_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define CYCAMORE_NOTHROW throw()
+#endif
+
+namespace {
+
+long n_allocs = 0;
+long n_bytes = 0;
+
+void* CountedAlloc(std::size_t size) {
+  __sync_fetch_and_add(&n_allocs, 1);
+  __sync_fetch_and_add(&n_bytes, static_cast<long>(size));
+  if (size == 0) {
+    size = 1;
+  }
+  void* p;
+  while ((p = std::malloc(size)) == NULL) {
+    std::new_handler h = std::set_new_handler(NULL);
+    std::set_new_handler(h);
+    if (h == NULL) {
+      return NULL;
+    }
+    h();
+  }
+  return p;
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) CYCAMORE_THROW_BAD_ALLOC {
+  void* p = CountedAlloc(size);
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void* operator new[](std::size_t size) CYCAMORE_THROW_BAD_ALLOC {
+  void* p = CountedAlloc(size);
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) CYCAMORE_NOTHROW {
+  return CountedAlloc(size);
+}
+
+void* operator new[](std::size_t size,
+                     const std::nothrow_t&) CYCAMORE_NOTHROW {
+  return CountedAlloc(size);
+}
+
+void operator delete(void* p) CYCAMORE_NOTHROW {
+  std::free(p);
+}
+
+void operator delete[](void* p) CYCAMORE_NOTHROW {
+  std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) CYCAMORE_NOTHROW {
+  std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) CYCAMORE_NOTHROW {
+  std::free(p);
+}
+
+namespace cycamore {
+
+long AllocCount() {
+  return __sync_fetch_and_add(&n_allocs, 0);
+}
+
+long AllocBytes() {
+  return __sync_fetch_and_add(&n_bytes, 0);
+}
+
+}  // namespace cycamore
@@ -0,0 +1,56 @@
+#ifndef CYCAMORE_TESTS_ALLOC_COUNTER_H_
+#define CYCAMORE_TESTS_ALLOC_COUNTER_H_
+
+/// @file alloc_counter.h
+///
+/// The cycamore unit test driver replaces the global operator new and delete
+/// with versions that count every heap allocation made by the process -
+/// including the ones made inside the cycamore and cyclus libraries.  Tests
+/// use an AllocCounter (or the EXPECT_ALLOCS_LE macro) to assert an allocation
+/// budget for a single call on an archetype hot path so that allocation
+/// regressions show up as unit test failures.
+
+namespace cycamore {
+
+/// Returns the number of heap allocations made by the process so far.
+long AllocCount();
+
+/// Returns the number of bytes requested from the heap by the process so far.
+long AllocBytes();
+
+/// Counts the heap allocations made between its construction and a call to
+/// count().
+class AllocCounter {
+ public:
+  AllocCounter() : start_(AllocCount()), start_bytes_(AllocBytes()) {}
+
+  /// Allocations made since construction (or the last reset).
+  inline long count() const { return AllocCount() - start_; }
+
+  /// Bytes allocated since construction (or the last reset).
+  inline long bytes() const { return AllocBytes() - start_bytes_; }
+
+  inline void reset() {
+    start_ = AllocCount();
+    start_bytes_ = AllocBytes();
+  }
+
+ private:
+  long start_;
+  long start_bytes_;
+};
+
+}  // namespace cycamore
+
+/// Runs stmt and expects it to make at most budget heap allocations.  The
+/// statement should only contain the call being measured - build arguments
+/// such as strings and maps beforehand.
+#define EXPECT_ALLOCS_LE(budget, stmt) \
+  do { \
+    cycamore::AllocCounter alloc_counter_; \
+    stmt; \
+    long allocs_ = alloc_counter_.count(); \
+    EXPECT_LE(allocs_, budget) << "heap allocations made by: " #stmt; \
+  } while (0)
+
+#endif  // CYCAMORE_TESTS_ALLOC_COUNTER_H_
@@ -0,0 +1,159 @@
+#!/usr/bin/env python
+"""Runs scenario_gen.py fuel cycles at increasing sizes and reports how the
+cost of a simulation grows with the size of the fleet.
+
+For each size the driver generates an input file, runs cyclus on it and
+records the wall time, the wall time per time step, the peak resident memory
+and the size of the output database.  Every number is also reported relative
+to the number of reactors and to the smallest size so that departures from
+linear scaling stand out.  Other facility counts are scaled along with the
+reactors using the given ratios.
+"""
+from __future__ import print_function
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+try:
+    import argparse as ap
+except ImportError:
+    import pyne._argparse as ap
+
+import scenario_gen
+
+def run_cyclus(cyclus, infile, outdb, cwd, flag="-v0"):
+    """Runs cyclus and returns (returncode, wall time in s, peak rss in kB)"""
+    cmd = [cyclus, infile, "-o", outdb, flag]
+    with open(os.path.join(cwd, "cyclus.log"), "w") as log:
+        start = time.time()
+        p = subprocess.Popen(cmd, cwd=cwd, stdout=log,
+                             stderr=subprocess.STDOUT)
+        _, status, usage = os.wait4(p.pid, 0)
+        wall = time.time() - start
+    if os.WIFSIGNALED(status):
+        rtn = -os.WTERMSIG(status)
+    else:
+        rtn = os.WEXITSTATUS(status)
+    rss = usage.ru_maxrss
+    if sys.platform == "darwin":
+        rss //= 1024
+    return rtn, wall, rss
+
+def scaled(n, ratio):
+    """Number of facilities to pair with n reactors"""
+    return max(1, int(round(n * ratio)))
+
+def bench(sizes, args):
+    """Runs each size and returns a list of per size results"""
+    results = []
+    kw = scenario_gen.scenario_kwargs(args)
+    for n in sizes:
+        kw["reactors"] = n
+        kw["enrichments"] = scaled(n, args.enrichment_ratio)
+        kw["fuelfabs"] = scaled(n, args.fuelfab_ratio)
+        kw["sources"] = 2 * scaled(n, args.source_ratio)
+        kw["sinks"] = scaled(n, args.sink_ratio)
+        kw["stagger"] = min(n, args.stagger)
+
+        cwd = tempfile.mkdtemp(prefix="cyc_bench_{0}_".format(n))
+        infile = os.path.join(cwd, "scenario_{0}.xml".format(n))
+        outdb = os.path.join(cwd, "scenario_{0}.{1}".format(n, args.backend))
+        with open(infile, "w") as f:
+            f.write(scenario_gen.scenario(**kw))
+
+        best = None
+        for rep in range(args.repeat):
+            if os.path.exists(outdb):
+                os.remove(outdb)
+            rtn, wall, rss = run_cyclus(args.cyclus, infile, outdb, cwd)
+            if rtn != 0:
+                break
+            if best is None or wall < best[0]:
+                best = (wall, rss)
+        res = dict(kw)
+        res["returncode"] = rtn
+        if rtn == 0:
+            wall, rss = best
+            res["wall_time"] = wall
+            res["time_per_step"] = wall / kw["duration"]
+            res["peak_rss_kb"] = rss
+            res["db_size"] = os.path.getsize(outdb)
+        if rtn != 0 or args.keep:
+            print("run for {0} reactors kept in {1}".format(n, cwd))
+        else:
+            shutil.rmtree(cwd, ignore_errors=True)
+        results.append(res)
+        if rtn != 0:
+            print("cyclus failed for {0} reactors (exit code {1}) - "
+                  "stopping".format(n, rtn))
+            break
+        print_row(res, results[0])
+        sys.stdout.flush()
+    return results
+
+def print_header():
+    print("{0:>9} {1:>8} {2:>12} {3:>12} {4:>10} {5:>12} {6:>9}".format(
+          "reactors", "agents", "s/step", "ms/step/rx", "rss (MB)",
+          "db (MB)", "scaling"))
+
+def print_row(res, base):
+    """Prints a row - scaling is the time per step per reactor relative to
+    the smallest size, so 1.0 means linear scaling"""
+    n = res["reactors"]
+    agents = (n + res["enrichments"] + res["fuelfabs"] + res["sources"] +
+              res["sinks"])
+    per_rx = res["time_per_step"] / n
+    base_per_rx = base["time_per_step"] / base["reactors"]
+    print("{0:>9} {1:>8} {2:>12.4f} {3:>12.4f} {4:>10.1f} {5:>12.2f} "
+          "{6:>9.2f}".format(n, agents, res["time_per_step"], 1e3 * per_rx,
+                             res["peak_rss_kb"] / 1024.0,
+                             res["db_size"] / 1024.0 ** 2,
+                             per_rx / base_per_rx if base_per_rx > 0 else 0))
+
+def main():
+    description = ("Benchmarks cycamore archetypes over increasing fleet "
+                   "sizes.")
+    parser = ap.ArgumentParser(description=description)
+    parser.add_argument("--sizes", default="1,10,100,1000",
+                        help="comma separated reactor counts to run "
+                             "(default: 1,10,100,1000)")
+    parser.add_argument("--enrichment-ratio", type=float, default=0.1,
+                        help="enrichment facilities per reactor")
+    parser.add_argument("--fuelfab-ratio", type=float, default=0.1,
+                        help="fuel fabrication facilities per reactor")
+    parser.add_argument("--source-ratio", type=float, default=0.05,
+                        help="sources of each kind (natural u and pu) per "
+                             "reactor")
+    parser.add_argument("--sink-ratio", type=float, default=0.1,
+                        help="sinks per reactor")
+    parser.add_argument("--repeat", type=int, default=1,
+                        help="runs per size - the fastest one is reported")
+    parser.add_argument("--backend", default="sqlite",
+                        choices=["sqlite", "h5"],
+                        help="output database format")
+    parser.add_argument("--cyclus", default="cyclus",
+                        help="the cyclus executable to run")
+    parser.add_argument("--keep", action="store_true", default=False,
+                        help="keep the generated inputs and databases")
+    parser.add_argument("-o", "--output", default=None,
+                        help="path to write json results to")
+    scenario_gen.add_scenario_args(parser)
+    args = parser.parse_args()
+    args.repeat = max(1, args.repeat)
+
+    sizes = sorted([int(s) for s in args.sizes.split(",") if s.strip()])
+    print_header()
+    results = bench(sizes, args)
+    if args.output is not None:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+    ok = len(results) == len(sizes) and results[-1]["returncode"] == 0
+    return 0 if ok else 1
+
+if __name__ == "__main__":
+    sys.exit(main())
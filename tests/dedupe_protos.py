@@ -0,0 +1,108 @@
+#!/usr/bin/env python
+"""Merges facility prototypes with identical configurations in a cyclus input
+file.
+
+Generated inputs often define thousands of facility prototypes that differ in
+name only.  Every one of them is parsed, validated and stored as a separate
+prototype when the simulation is loaded.  This script hashes the content of
+each facility element other than its name (ignoring whitespace) - its config
+as well as e.g. its lifetime - keeps the first prototype of each distinct
+content and points every reference to a duplicate -
+initial facility list entries and <prototype>/<prototypes> values in
+institution and region configs - at the kept prototype instead.  Initial
+facility list entries of an institution that end up naming the same
+prototype are merged.
+
+Note that the merged prototypes are recorded under the kept name in the
+output database.
+"""
+from __future__ import print_function
+
+import hashlib
+import sys
+import xml.etree.ElementTree as ET
+
+try:
+    import argparse as ap
+except ImportError:
+    import pyne._argparse as ap
+
+def canonical(elem):
+    """Returns a whitespace insensitive string form of an element"""
+    text = (elem.text or "").strip()
+    kids = "".join([canonical(kid) for kid in elem])
+    return "<{0}>{1}{2}</{0}>".format(elem.tag, text, kids)
+
+def content_hash(facility):
+    """Returns the hash of a facility element without its name"""
+    s = "".join([canonical(kid) for kid in facility if kid.tag != "name"])
+    return hashlib.sha1(s.encode("utf-8")).hexdigest()
+
+def rename_refs(elem, renamed):
+    """Renames prototype references below elem"""
+    for ref in elem.iter("prototype"):
+        name = (ref.text or "").strip()
+        if name in renamed:
+            ref.text = renamed[name]
+    for refs in elem.iter("prototypes"):
+        for val in refs.iter("val"):
+            name = (val.text or "").strip()
+            if name in renamed:
+                val.text = renamed[name]
+
+def merge_entries(facility_list):
+    """Merges initial facility list entries for the same prototype"""
+    kept = {}
+    for entry in list(facility_list.findall("entry")):
+        name = entry.find("prototype").text.strip()
+        number = entry.find("number")
+        if name not in kept:
+            kept[name] = number
+            continue
+        kept[name].text = str(int(kept[name].text) + int(number.text))
+        facility_list.remove(entry)
+
+def dedupe(root):
+    """Merges duplicate facility prototypes in the parsed input in place and
+    returns a dict mapping removed prototype names to kept ones."""
+    kept = {}
+    renamed = {}
+    for facility in list(root.findall("facility")):
+        name = facility.find("name").text.strip()
+        h = content_hash(facility)
+        if h not in kept:
+            kept[h] = name
+            continue
+        renamed[name] = kept[h]
+        root.remove(facility)
+
+    for region in root.findall("region"):
+        rename_refs(region, renamed)
+        for facility_list in region.iter("initialfacilitylist"):
+            merge_entries(facility_list)
+    return renamed
+
+def main():
+    description = "Merges identical facility prototypes in a cyclus input."
+    parser = ap.ArgumentParser(description=description)
+    parser.add_argument("input", help="input file to read")
+    parser.add_argument("-o", "--output", default=None,
+                        help="file to write to (default: stdout)")
+    args = parser.parse_args()
+
+    tree = ET.parse(args.input)
+    root = tree.getroot()
+    n = len(root.findall("facility"))
+    renamed = dedupe(root)
+    print("{0} facility prototypes, {1} after merging".format(
+          n, n - len(renamed)), file=sys.stderr)
+
+    if args.output is None:
+        out = sys.stdout if sys.version_info[0] < 3 else sys.stdout.buffer
+        tree.write(out)
+    else:
+        tree.write(args.output)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
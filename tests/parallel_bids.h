@@ -0,0 +1,98 @@
+#ifndef CYCAMORE_TESTS_PARALLEL_BIDS_H_
+#define CYCAMORE_TESTS_PARALLEL_BIDS_H_
+
+/// @file parallel_bids.h
+///
+/// Helpers for tests that bid for many agents on a pool of threads at once
+/// and compare the bids with those of identical agents bid for one at a time.
+
+#include <pthread.h>
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cyclus.h"
+
+namespace cycamore {
+
+typedef std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> BidSet;
+
+/// Describes each bid in ports by its commodity, quantity and composition -
+/// independent of the order of portfolios and bids.
+inline std::multiset<std::string> DescribeBids(const BidSet& ports) {
+  std::multiset<std::string> descs;
+  BidSet::const_iterator port;
+  for (port = ports.begin(); port != ports.end(); ++port) {
+    const std::set<cyclus::Bid<cyclus::Material>*>& bids = (*port)->bids();
+    std::set<cyclus::Bid<cyclus::Material>*>::const_iterator bid;
+    for (bid = bids.begin(); bid != bids.end(); ++bid) {
+      std::stringstream ss;
+      ss.precision(17);
+      ss << (*bid)->request()->commodity() << " "
+         << (*bid)->offer()->quantity();
+      const cyclus::CompMap& v = (*bid)->offer()->comp()->mass();
+      cyclus::CompMap::const_iterator it;
+      for (it = v.begin(); it != v.end(); ++it) {
+        ss << " " << it->first << ":" << it->second;
+      }
+      descs.insert(ss.str());
+    }
+  }
+  return descs;
+}
+
+namespace parallel_bids {
+
+// A thread bids for every n_threads-th trader starting at first - each trader
+// is bid for by a single thread.
+struct Work {
+  const std::vector<cyclus::Trader*>* traders;
+  std::vector<BidSet>* bids;
+  cyclus::CommodMap<cyclus::Material>::type* reqs;
+  int first;
+  int n_threads;
+};
+
+inline void* Run(void* arg) {
+  Work* w = static_cast<Work*>(arg);
+  for (int i = w->first; i < w->traders->size(); i += w->n_threads) {
+    (*w->bids)[i] = (*w->traders)[i]->GetMatlBids(*w->reqs);
+  }
+  return NULL;
+}
+
+}  // namespace parallel_bids
+
+/// Returns the bids of each of agents for reqs, made on n_threads threads at
+/// once.
+template <class T>
+std::vector<BidSet> BidInParallel(
+    const std::vector<T*>& agents,
+    cyclus::CommodMap<cyclus::Material>::type& reqs, int n_threads) {
+  std::vector<cyclus::Trader*> traders(agents.begin(), agents.end());
+  std::vector<BidSet> bids(agents.size());
+  std::vector<parallel_bids::Work> work(n_threads);
+  std::vector<pthread_t> threads(n_threads);
+  std::vector<bool> started(n_threads, false);
+  for (int k = 0; k < n_threads; k++) {
+    parallel_bids::Work w = {&traders, &bids, &reqs, k, n_threads};
+    work[k] = w;
+    started[k] = pthread_create(&threads[k], NULL, parallel_bids::Run,
+                                &work[k]) == 0;
+    EXPECT_TRUE(started[k]) << "cannot start bid thread " << k;
+  }
+  for (int k = 0; k < n_threads; k++) {
+    if (started[k]) {
+      pthread_join(threads[k], NULL);
+    }
+  }
+  return bids;
+}
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_TESTS_PARALLEL_BIDS_H_
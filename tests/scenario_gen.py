@@ -0,0 +1,356 @@
+#!/usr/bin/env python
+"""Generates cyclus input files for scaled up cycamore fuel cycles.
+
+The generated scenario is a once-through uranium cycle with an optional MOX
+recycle loop built from the cycamore archetypes:
+
+    Source (natl_u) -> Enrichment -> Reactor (uox) -> Sink (waste)
+    Source (sep_pu) + Enrichment tails -> FuelFab -> Reactor (mox)
+
+The number of reactors, enrichment facilities, fuel fabrication facilities,
+sources and sinks are all parameters so that the same scenario can be run at
+increasing sizes.  Facilities of each kind are all deployed at the start of
+the simulation from a single prototype each - except that reactors can be
+split over several prototypes with staggered initial cycle steps so that
+their refueling does not line up.
+"""
+from __future__ import print_function
+
+import sys
+
+try:
+    import argparse as ap
+except ImportError:
+    import pyne._argparse as ap
+
+HEAD = """<!-- generated by scenario_gen.py: {desc} -->
+
+<simulation>
+  <control>
+    <duration>{duration}</duration>
+    <startmonth>1</startmonth>
+    <startyear>2000</startyear>
+  </control>
+
+  <archetypes>
+    <spec> <lib>cycamore</lib> <name>Source</name> </spec>
+    <spec> <lib>cycamore</lib> <name>Sink</name> </spec>
+    <spec> <lib>cycamore</lib> <name>Enrichment</name> </spec>
+    <spec> <lib>cycamore</lib> <name>FuelFab</name> </spec>
+    <spec> <lib>cycamore</lib> <name>Reactor</name> </spec>
+    <spec> <lib>agents</lib>   <name>NullRegion</name> </spec>
+    <spec> <lib>agents</lib>   <name>NullInst</name> </spec>
+  </archetypes>
+"""
+
+SOURCE = """
+  <facility>
+    <name>{name}</name>
+    <config>
+      <Source>
+        <outcommod>{commod}</outcommod>
+        <outrecipe>{recipe}</outrecipe>
+        <throughput>{throughput}</throughput>
+      </Source>
+    </config>
+  </facility>
+"""
+
+SINK = """
+  <facility>
+    <name>{name}</name>
+    <config>
+      <Sink>
+        <in_commods> <val>waste</val> </in_commods>
+        <capacity>{capacity}</capacity>
+      </Sink>
+    </config>
+  </facility>
+"""
+
+ENRICHMENT = """
+  <facility>
+    <name>{name}</name>
+    <config>
+      <Enrichment>
+        <feed_commod>natl_u</feed_commod>
+        <feed_recipe>natl_u</feed_recipe>
+        <product_commod>uox</product_commod>
+        <tails_commod>tails</tails_commod>
+        <tails_assay>0.003</tails_assay>
+        <swu_capacity>{swu}</swu_capacity>
+        <max_feed_inventory>{feed}</max_feed_inventory>
+      </Enrichment>
+    </config>
+  </facility>
+"""
+
+FUELFAB = """
+  <facility>
+    <name>{name}</name>
+    <config>
+      <FuelFab>
+        <fill_commod>tails</fill_commod>
+        <fill_recipe>depleted_u</fill_recipe>
+        <fill_size>{fill_size}</fill_size>
+        <fiss_commods> <val>sep_pu</val> </fiss_commods>
+        <fiss_recipe>sep_pu</fiss_recipe>
+        <fiss_size>{fiss_size}</fiss_size>
+        <outcommod>mox</outcommod>
+        <spectrum>thermal</spectrum>
+        <throughput>{throughput}</throughput>
+      </FuelFab>
+    </config>
+  </facility>
+"""
+
+REACTOR = """
+  <facility>
+    <name>{name}</name>
+    <config>
+      <Reactor>
+        <fuel_inrecipes>  <val>uox</val>       <val>mox</val>       </fuel_inrecipes>
+        <fuel_outrecipes> <val>spent_uox</val> <val>spent_mox</val> </fuel_outrecipes>
+        <fuel_incommods>  <val>uox</val>       <val>mox</val>       </fuel_incommods>
+        <fuel_outcommods> <val>waste</val>     <val>waste</val>     </fuel_outcommods>
+        <fuel_prefs>      <val>1.0</val>       <val>{mox_pref}</val> </fuel_prefs>
+
+        <cycle_time>{cycle_time}</cycle_time>
+        <refuel_time>{refuel_time}</refuel_time>
+        <cycle_step>{cycle_step}</cycle_step>
+        <assem_size>{assem_size}</assem_size>
+        <n_assem_core>{n_assem_core}</n_assem_core>
+        <n_assem_batch>{n_assem_batch}</n_assem_batch>
+        <n_assem_spent>{n_assem_spent}</n_assem_spent>
+
+        <power_cap>{power_cap}</power_cap>
+        <power_intervals>{power_intervals}</power_intervals>
+      </Reactor>
+    </config>
+  </facility>
+"""
+
+ENTRY = """        <entry>
+          <prototype>{proto}</prototype>
+          <number>{number}</number>
+        </entry>
+"""
+
+REGION = """
+  <region>
+    <name>SingleRegion</name>
+    <config><NullRegion/></config>
+    <institution>
+      <name>SingleInstitution</name>
+      <initialfacilitylist>
+{entries}      </initialfacilitylist>
+      <config><NullInst/></config>
+    </institution>
+  </region>
+"""
+
+RECIPES = """
+  <recipe>
+    <name>natl_u</name>
+    <basis>mass</basis>
+    <nuclide> <id>922350000</id> <comp>0.711</comp> </nuclide>
+    <nuclide> <id>922380000</id> <comp>99.289</comp> </nuclide>
+  </recipe>
+
+  <recipe>
+    <name>depleted_u</name>
+    <basis>mass</basis>
+    <nuclide> <id>922350000</id> <comp>0.3</comp> </nuclide>
+    <nuclide> <id>922380000</id> <comp>99.7</comp> </nuclide>
+  </recipe>
+
+  <recipe>
+    <name>uox</name>
+    <basis>mass</basis>
+    <nuclide> <id>922350000</id> <comp>4.0</comp> </nuclide>
+    <nuclide> <id>922380000</id> <comp>96.0</comp> </nuclide>
+  </recipe>
+
+  <recipe>
+    <name>sep_pu</name>
+    <basis>mass</basis>
+    <nuclide> <id>942380000</id> <comp>2.0</comp> </nuclide>
+    <nuclide> <id>942390000</id> <comp>58.0</comp> </nuclide>
+    <nuclide> <id>942400000</id> <comp>24.0</comp> </nuclide>
+    <nuclide> <id>942410000</id> <comp>10.0</comp> </nuclide>
+    <nuclide> <id>942420000</id> <comp>6.0</comp> </nuclide>
+  </recipe>
+
+  <recipe>
+    <name>mox</name>
+    <basis>mass</basis>
+    <nuclide> <id>922350000</id> <comp>0.2</comp> </nuclide>
+    <nuclide> <id>922380000</id> <comp>92.0</comp> </nuclide>
+    <nuclide> <id>942390000</id> <comp>5.0</comp> </nuclide>
+    <nuclide> <id>942400000</id> <comp>2.0</comp> </nuclide>
+    <nuclide> <id>942410000</id> <comp>0.8</comp> </nuclide>
+  </recipe>
+
+  <recipe>
+    <name>spent_uox</name>
+    <basis>mass</basis>
+    <nuclide> <id>922350000</id> <comp>0.8</comp> </nuclide>
+    <nuclide> <id>922360000</id> <comp>0.5</comp> </nuclide>
+    <nuclide> <id>922380000</id> <comp>93.4</comp> </nuclide>
+    <nuclide> <id>942390000</id> <comp>0.6</comp> </nuclide>
+    <nuclide> <id>942400000</id> <comp>0.2</comp> </nuclide>
+    <nuclide> <id>942410000</id> <comp>0.1</comp> </nuclide>
+    <nuclide> <id>551370000</id> <comp>4.4</comp> </nuclide>
+  </recipe>
+
+  <recipe>
+    <name>spent_mox</name>
+    <basis>mass</basis>
+    <nuclide> <id>922350000</id> <comp>0.1</comp> </nuclide>
+    <nuclide> <id>922380000</id> <comp>89.9</comp> </nuclide>
+    <nuclide> <id>942390000</id> <comp>3.0</comp> </nuclide>
+    <nuclide> <id>942400000</id> <comp>2.2</comp> </nuclide>
+    <nuclide> <id>942410000</id> <comp>1.0</comp> </nuclide>
+    <nuclide> <id>551370000</id> <comp>3.8</comp> </nuclide>
+  </recipe>
+"""
+
+TAIL = """
+</simulation>
+"""
+
+DEFAULTS = {
+    "reactors": 10,
+    "enrichments": 1,
+    "fuelfabs": 1,
+    "sources": 2,
+    "sinks": 1,
+    "duration": 120,
+    "cycle_time": 18,
+    "refuel_time": 1,
+    "n_assem_core": 3,
+    "n_assem_batch": 1,
+    "assem_size": 1000.0,
+    "stagger": 1,
+    "mox_pref": 0.5,
+    "power_intervals": 0,
+    }
+
+def scenario(reactors=DEFAULTS["reactors"],
+             enrichments=DEFAULTS["enrichments"],
+             fuelfabs=DEFAULTS["fuelfabs"],
+             sources=DEFAULTS["sources"],
+             sinks=DEFAULTS["sinks"],
+             duration=DEFAULTS["duration"],
+             cycle_time=DEFAULTS["cycle_time"],
+             refuel_time=DEFAULTS["refuel_time"],
+             n_assem_core=DEFAULTS["n_assem_core"],
+             n_assem_batch=DEFAULTS["n_assem_batch"],
+             assem_size=DEFAULTS["assem_size"],
+             stagger=DEFAULTS["stagger"],
+             mox_pref=DEFAULTS["mox_pref"],
+             power_intervals=DEFAULTS["power_intervals"]):
+    """Returns the text of a cyclus input file for a fleet with the given
+    numbers of each facility type.
+
+    Sources alternate between natural uranium and separated plutonium (so at
+    least two are needed for both fuel types to be available).  Reactors are
+    split over ``stagger`` prototypes whose initial cycle steps are evenly
+    spread over the cycle.  Enrichment, fuel fabrication and sink capacities
+    are sized so that the fleet as a whole is supplied.  If
+    ``power_intervals`` is nonzero, reactors record their power as intervals
+    rather than once per time step.
+    """
+    if reactors < 1:
+        raise ValueError("a scenario needs at least one reactor")
+    stagger = max(1, min(stagger, reactors, cycle_time))
+    desc = ("{0} reactors, {1} enrichments, {2} fuelfabs, {3} sources, "
+            "{4} sinks").format(reactors, enrichments, fuelfabs, sources,
+                                sinks)
+    parts = [HEAD.format(desc=desc, duration=duration)]
+    entries = []
+
+    # fuel mass needed by the whole fleet per time step, with generous margin
+    fleet_rate = 2.0 * reactors * n_assem_core * assem_size / cycle_time
+
+    natu_sources = (sources + 1) // 2
+    pu_sources = sources // 2
+    if natu_sources > 0:
+        parts.append(SOURCE.format(name="NatUSource", commod="natl_u",
+                                   recipe="natl_u",
+                                   throughput=10 * fleet_rate / natu_sources))
+        entries.append(ENTRY.format(proto="NatUSource", number=natu_sources))
+    if pu_sources > 0:
+        parts.append(SOURCE.format(name="PuSource", commod="sep_pu",
+                                   recipe="sep_pu",
+                                   throughput=fleet_rate / pu_sources))
+        entries.append(ENTRY.format(proto="PuSource", number=pu_sources))
+
+    if enrichments > 0:
+        # ~8 kg swu and ~10 kg natu per kg of 4% product at 0.3% tails
+        per = fleet_rate / enrichments
+        parts.append(ENRICHMENT.format(name="Enrichment", swu=8 * per,
+                                       feed=20 * per))
+        entries.append(ENTRY.format(proto="Enrichment", number=enrichments))
+
+    if fuelfabs > 0:
+        per = fleet_rate / fuelfabs
+        parts.append(FUELFAB.format(name="FuelFab", fill_size=2 * per,
+                                    fiss_size=per / 4, throughput=per))
+        entries.append(ENTRY.format(proto="FuelFab", number=fuelfabs))
+
+    if sinks > 0:
+        parts.append(SINK.format(name="Repository",
+                                 capacity=2 * fleet_rate / sinks))
+        entries.append(ENTRY.format(proto="Repository", number=sinks))
+
+    for i in range(stagger):
+        name = "Reactor{0}".format(i)
+        n = reactors // stagger + (1 if i < reactors % stagger else 0)
+        parts.append(REACTOR.format(name=name, mox_pref=mox_pref,
+                                    cycle_time=cycle_time,
+                                    refuel_time=refuel_time,
+                                    cycle_step=i * cycle_time // stagger,
+                                    assem_size=assem_size,
+                                    n_assem_core=n_assem_core,
+                                    n_assem_batch=n_assem_batch,
+                                    n_assem_spent=1000000000,
+                                    power_cap=1000,
+                                    power_intervals=int(power_intervals != 0)))
+        entries.append(ENTRY.format(proto=name, number=n))
+
+    parts.append(REGION.format(entries="".join(entries)))
+    parts.append(RECIPES)
+    parts.append(TAIL)
+    return "".join(parts)
+
+def add_scenario_args(parser):
+    """Adds the scenario parameters to an argument parser"""
+    for key in sorted(DEFAULTS.keys()):
+        val = DEFAULTS[key]
+        parser.add_argument("--" + key.replace("_", "-"), dest=key,
+                            type=type(val), default=val,
+                            help="default: {0}".format(val))
+
+def scenario_kwargs(args):
+    """Returns the scenario parameters from parsed arguments"""
+    return dict([(key, getattr(args, key)) for key in DEFAULTS])
+
+def main():
+    description = "Generates a scaled cycamore fuel cycle input file."
+    parser = ap.ArgumentParser(description=description)
+    parser.add_argument("-o", "--output", default=None,
+                        help="file to write to (default: stdout)")
+    add_scenario_args(parser)
+    args = parser.parse_args()
+
+    text = scenario(**scenario_kwargs(args))
+    if args.output is None:
+        sys.stdout.write(text)
+    else:
+        with open(args.output, "w") as f:
+            f.write(text)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
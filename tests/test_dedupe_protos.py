@@ -0,0 +1,61 @@
+#! /usr/bin/env python
+
+import xml.etree.ElementTree as ET
+
+from nose.tools import assert_equal
+
+from dedupe_protos import dedupe
+
+INPUT = """<simulation>
+  <facility>
+    <name>a</name>
+    <config><Sink><in_commods><val>waste</val></in_commods></Sink></config>
+  </facility>
+  <facility>
+    <name>b</name>
+    <config>
+      <Sink> <in_commods> <val>waste</val> </in_commods> </Sink>
+    </config>
+  </facility>
+  <facility>
+    <name>c</name>
+    <lifetime>10</lifetime>
+    <config><Sink><in_commods><val>waste</val></in_commods></Sink></config>
+  </facility>
+  <region>
+    <name>r</name>
+    <config><NullRegion/></config>
+    <institution>
+      <name>i</name>
+      <initialfacilitylist>
+        <entry><prototype>a</prototype><number>1</number></entry>
+        <entry><prototype>b</prototype><number>2</number></entry>
+        <entry><prototype>c</prototype><number>3</number></entry>
+      </initialfacilitylist>
+      <config><NullInst/></config>
+    </institution>
+  </region>
+</simulation>
+"""
+
+def test_merge():
+    root = ET.fromstring(INPUT)
+    renamed = dedupe(root)
+    assert_equal({"b": "a"}, renamed)
+    names = [f.find("name").text for f in root.findall("facility")]
+    assert_equal(["a", "c"], names)
+
+    entries = root.find("region").find("institution").find(
+        "initialfacilitylist").findall("entry")
+    got = [(e.find("prototype").text, e.find("number").text) for e in entries]
+    assert_equal([("a", "3"), ("c", "3")], got)
+
+def test_lifetimes_kept():
+    # same config, different lifetimes - both must be kept
+    root = ET.fromstring(INPUT.replace("<name>a</name>",
+                                       "<name>a</name><lifetime>20</lifetime>"))
+    renamed = dedupe(root)
+    assert_equal({}, renamed)
+    lifetimes = [f.find("lifetime").text for f in root.findall("facility")
+                 if f.find("lifetime") is not None]
+    assert_equal(["20", "10"], lifetimes)
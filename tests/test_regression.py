@@ -6,6 +6,7 @@ from unittest import TestCase
 
 import tables
 import uuid
+import xml.etree.ElementTree as ET
 import sqlite3
 import numpy as np
 from numpy.testing import assert_array_almost_equal 
@@ -375,3 +376,86 @@ class TestGrowth(TestRegression):
         assert_equal(depl_time[np.where(agent_ids == source1_id[0])], 2)
         assert_equal(depl_time[np.where(agent_ids == source1_id[1])], 3)
 
+
+class TestPhysorFleet(TestCase):
+    """Runs 1_Enrichment_2_Reactor.xml with Reactor1 deployed as N separate
+    Reactors and as one ReactorFleet of N units (Reactor2 is left out) and
+    checks that both record the same traded quantities per commodity, power
+    and reactor events.
+    """
+    n = 3
+
+    def __init__(self, *args, **kwargs):
+        super(TestPhysorFleet, self).__init__(*args, **kwargs)
+        self.inf = "../input/physor/1_Enrichment_2_Reactor.xml"
+
+    def variant(self, fleet):
+        tree = ET.parse(self.inf)
+        root = tree.getroot()
+        for fac in root.findall("facility"):
+            if fac.find("name").text == "Reactor2":
+                root.remove(fac)
+        inst = root.find("region/institution/initialfacilitylist")
+        for entry in inst.findall("entry"):
+            proto = entry.find("prototype").text
+            if proto == "Reactor2":
+                inst.remove(entry)
+            elif proto == "Reactor1":
+                entry.find("number").text = "1" if fleet else str(self.n)
+
+        rx = root.find("facility/config/Reactor")
+        ET.SubElement(rx, "power_cap").text = "100"
+        if fleet:
+            rx.tag = "ReactorFleet"
+            ET.SubElement(rx, "n_units").text = str(self.n)
+            spec = ET.SubElement(root.find("archetypes"), "spec")
+            ET.SubElement(spec, "lib").text = "cycamore"
+            ET.SubElement(spec, "name").text = "ReactorFleet"
+
+        base = str(uuid.uuid4())
+        inf = base + ".xml"
+        outf = base + ".sqlite"
+        tree.write(inf)
+        self.files += [inf, outf]
+        run_cyclus("cyclus", os.getcwd(), inf, outf)
+        return outf
+
+    def setUp(self):
+        self.files = []
+
+    def tearDown(self):
+        for f in self.files:
+            if os.path.isfile(f):
+                os.remove(f)
+
+    def results(self, outf):
+        conn = sqlite3.connect(outf)
+        exc = conn.cursor().execute
+        xactions = {}
+        for t, commod, qty in exc(
+                "SELECT t.Time, t.Commodity, r.Quantity FROM Transactions t "
+                "JOIN Resources r ON t.ResourceId = r.ResourceId"):
+            key = (t, commod)
+            xactions[key] = round(xactions.get(key, 0) + qty, 6)
+        power = {}
+        for t, val in exc("SELECT Time, Value FROM TimeSeriesPower"):
+            power[t] = power.get(t, 0) + val
+        # a Reactor records one event per unit with an empty value or an
+        # assembly count, a fleet one event per step with a count
+        events = {}
+        for t, name, val in exc("SELECT Time, Event, Value FROM ReactorEvents"):
+            if val == "failed":
+                key, n = (t, name, val), 1
+            else:
+                key, n = (t, name), int(val.split()[0]) if val else 1
+            events[key] = events.get(key, 0) + n
+        conn.close()
+        return xactions, power, events
+
+    def test_matches_reactors(self):
+        exp = self.results(self.variant(False))
+        obs = self.results(self.variant(True))
+        assert_true(len(exp[0]) > 0)
+        assert_equal(exp[0], obs[0])
+        assert_equal(exp[1], obs[1])
+        assert_equal(exp[2], obs[2])